@@ -0,0 +1,269 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include <atomic>
+
+#include "Benchmark.h"
+#include "Core/Math/Random.h"
+#include "Core/Memory/PoolAllocator.h"
+#include "Core/Memory/RawAllocator.h"
+#include "Core/Memory/TaggedAllocator.h"
+#include "Core/Memory/ThreadCacheAllocator.h"
+#include "Core/Platform/Thread.h"
+#include "Core/Types/Map.h"
+
+namespace Ignis {
+
+/// Number of operations timed together.
+static constexpr u64 BatchSize = 64;
+
+static void Shuffle(Array<void*>& ptrs, u64& seed)
+{
+	for (u64 i = ptrs.Size() - 1; i > 0; i--)
+	{
+		u64 j = QuickRandom(seed) % (i + 1);
+		void* temp = ptrs[i];
+		ptrs[i] = ptrs[j];
+		ptrs[j] = temp;
+	}
+}
+
+/// Allocate many 64 byte objects, then free them in random order.
+static void SmallObjects(BenchmarkState& state)
+{
+	u64 count = state.Scaled(1024 * 1024) / BatchSize * BatchSize + BatchSize;
+	Array<void*> ptrs(count, GMallocAlloc);
+	u64 seed = 1;
+
+	for (u64 round = 0; round < 4; round++)
+	{
+		for (u64 i = 0; i < count; i += BatchSize)
+		{
+			auto start = BenchmarkState::Clock::now();
+			for (u64 j = i; j < i + BatchSize; j++)
+			{
+				ptrs[j] = state.Alloc.Allocate(64);
+				*static_cast<u8*>(ptrs[j]) = u8(j);
+			}
+			state.Record(start, BatchSize);
+		}
+		state.SampleMemory();
+
+		Shuffle(ptrs, seed);
+		for (u64 i = 0; i < count; i += BatchSize)
+		{
+			auto start = BenchmarkState::Clock::now();
+			for (u64 j = i; j < i + BatchSize; j++)
+			{
+				state.Alloc.Deallocate(ptrs[j]);
+			}
+			state.Record(start, BatchSize);
+		}
+	}
+}
+
+/// Bounded single producer, single consumer queue of pointers.
+struct PointerRing
+{
+	static constexpr u64 Capacity = 4096;
+
+	bool Push(void* ptr)
+	{
+		u64 tail = Tail.load(std::memory_order::relaxed);
+		if (tail - Head.load(std::memory_order::acquire) == Capacity)
+		{
+			return false;
+		}
+
+		Slots[tail % Capacity] = ptr;
+		Tail.store(tail + 1, std::memory_order::release);
+		return true;
+	}
+
+	void* Pop()
+	{
+		u64 head = Head.load(std::memory_order::relaxed);
+		if (head == Tail.load(std::memory_order::acquire))
+		{
+			return nullptr;
+		}
+
+		void* ptr = Slots[head % Capacity];
+		Head.store(head + 1, std::memory_order::release);
+		return ptr;
+	}
+
+	void* Slots[Capacity];
+	alignas(64) std::atomic<u64> Head = 0;
+	alignas(64) std::atomic<u64> Tail = 0;
+};
+
+/// Allocate objects of 16 to 256 bytes on one thread, and free them on another.
+static void CrossThread(BenchmarkState& state)
+{
+	u64 count = state.Scaled(4 * 1024 * 1024) / BatchSize * BatchSize + BatchSize;
+	auto ring = static_cast<PointerRing*>(GMallocAlloc.Allocate(sizeof(PointerRing)));
+	Construct<PointerRing>(ring);
+
+	Thread producer(
+		[&]
+		{
+			u64 seed = 2;
+			void* batch[BatchSize];
+			for (u64 i = 0; i < count; i += BatchSize)
+			{
+				auto start = BenchmarkState::Clock::now();
+				for (u64 j = 0; j < BatchSize; j++)
+				{
+					batch[j] = state.Alloc.Allocate(16 + QuickRandom(seed) % 241);
+				}
+				state.Record(start, BatchSize);
+
+				for (u64 j = 0; j < BatchSize; j++)
+				{
+					while (!ring->Push(batch[j])) {}
+				}
+			}
+		});
+
+	void* batch[BatchSize];
+	for (u64 i = 0; i < count; i += BatchSize)
+	{
+		for (u64 j = 0; j < BatchSize; j++)
+		{
+			while (!(batch[j] = ring->Pop())) {}
+		}
+
+		if (i % (64 * BatchSize) == 0)
+		{
+			state.SampleMemory();
+		}
+
+		auto start = BenchmarkState::Clock::now();
+		for (u64 j = 0; j < BatchSize; j++)
+		{
+			state.Alloc.Deallocate(batch[j]);
+		}
+		state.Record(start, BatchSize);
+	}
+
+	producer.Join();
+	GMallocAlloc.Deallocate(ring);
+}
+
+/// Push into many Arrays in random order, so that their reallocations interleave.
+static void GrowingArrays(BenchmarkState& state)
+{
+	constexpr u64 arrayCount = 1024;
+	u64 pushes = state.Scaled(4 * 1024 * 1024) / BatchSize * BatchSize + BatchSize;
+	u64 seed = 3;
+
+	for (u64 round = 0; round < 2; round++)
+	{
+		Array<Array<u64>> arrays(GMallocAlloc);
+		arrays.Reserve(arrayCount);
+		for (u64 i = 0; i < arrayCount; i++)
+		{
+			arrays.Emplace(state.Alloc);
+		}
+
+		for (u64 i = 0; i < pushes; i += BatchSize)
+		{
+			auto start = BenchmarkState::Clock::now();
+			for (u64 j = i; j < i + BatchSize; j++)
+			{
+				arrays[QuickRandom(seed) % arrayCount].Push(j);
+			}
+			state.Record(start, BatchSize);
+		}
+		state.SampleMemory();
+	}
+}
+
+/// Build strings of random length out of pieces, replacing random strings of a live set.
+static void StringChurn(BenchmarkState& state)
+{
+	constexpr u64 liveCount = 4096;
+	static const char* pieces[] = { "a", "entity", "/Game/Content/", "Transform", "_LOD0", "0123456789abcdef" };
+	u64 ops = state.Scaled(1024 * 1024) / BatchSize * BatchSize + BatchSize;
+	u64 seed = 4;
+
+	Array<String> strings(GMallocAlloc);
+	strings.Reserve(liveCount);
+	for (u64 i = 0; i < liveCount; i++)
+	{
+		strings.Emplace(state.Alloc);
+	}
+
+	for (u64 i = 0; i < ops; i += BatchSize)
+	{
+		auto start = BenchmarkState::Clock::now();
+		for (u64 j = 0; j < BatchSize; j++)
+		{
+			String string(state.Alloc);
+			for (u64 count = 1 + QuickRandom(seed) % 16; count > 0; count--)
+			{
+				string += pieces[QuickRandom(seed) % 6];
+			}
+			strings[QuickRandom(seed) % liveCount] = static_cast<String&&>(string);
+		}
+		state.Record(start, BatchSize);
+
+		if (i % (256 * BatchSize) == 0)
+		{
+			state.SampleMemory();
+		}
+	}
+}
+
+/// Insert into HashMaps from empty, so that they rehash as they grow.
+static void HashMapRehash(BenchmarkState& state)
+{
+	u64 inserts = state.Scaled(1024 * 1024) / BatchSize * BatchSize + BatchSize;
+
+	for (u64 round = 0; round < 4; round++)
+	{
+		HashMap<u64, u64> map(state.Alloc);
+		for (u64 i = 0; i < inserts; i += BatchSize)
+		{
+			auto start = BenchmarkState::Clock::now();
+			for (u64 j = i; j < i + BatchSize; j++)
+			{
+				map.Insert(j * 0x9E3779B97F4A7C15, j);
+			}
+			state.Record(start, BatchSize);
+		}
+		state.SampleMemory();
+	}
+}
+
+void RunAllocatorBenchmarks(BenchmarkRunner& runner)
+{
+	struct Workload
+	{
+		const char* Name;
+		BenchmarkFunction Function;
+	};
+
+	static const Workload workloads[] = {
+		{ "SmallObjects", &SmallObjects },
+		{ "CrossThread", &CrossThread },
+		{ "GrowingArrays", &GrowingArrays },
+		{ "StringChurn", &StringChurn },
+		{ "HashMapRehash", &HashMapRehash },
+	};
+
+	TaggedAllocator tagged(MemoryTag::User);
+	for (const Workload& workload : workloads)
+	{
+		runner.Run(workload.Name, "malloc", GMallocAlloc, workload.Function);
+		runner.Run(workload.Name, "RawAllocator", GRawAlloc, workload.Function);
+		runner.Run(workload.Name, "ThreadCacheAllocator", GCacheAlloc, workload.Function);
+		runner.Run(workload.Name, "TaggedAllocator", tagged, workload.Function);
+	}
+
+	// Only fixed-size workloads can use a pool.
+	PoolAllocator<64> pool;
+	runner.Run("SmallObjects", "PoolAllocator", pool, &SmallObjects);
+}
+
+}
@@ -0,0 +1,137 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+
+#include "Core/Misc/Assert.h"
+#include "Core/Misc/Format.h"
+
+#ifdef PLATFORM_WINDOWS
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#	include <Psapi.h>
+#else
+#	include <cstdio>
+#	include <unistd.h>
+#endif
+
+namespace Ignis {
+
+MallocAllocator GMallocAlloc;
+
+void* MallocAllocator::Allocate(u64 size) { return malloc(size); }
+
+void* MallocAllocator::Allocate(u64 size, u64 alignment)
+{
+	IASSERT(alignment <= 16, "MallocAllocator only supports 16 byte alignment");
+	return malloc(size);
+}
+
+void MallocAllocator::Deallocate(void* ptr) { free(ptr); }
+
+BenchmarkState::BenchmarkState(Allocator& alloc, double scale) : Alloc(alloc), m_Scale(scale)
+{
+	m_Latencies.Reserve(1024 * 1024);
+}
+
+u64 BenchmarkState::Scaled(u64 count) const
+{
+	u64 scaled = u64(double(count) * m_Scale);
+	return scaled ? scaled : 1;
+}
+
+void BenchmarkState::Record(Clock::time_point start, u64 ops)
+{
+	double nanoseconds = double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+	while (m_Lock.test_and_set(std::memory_order::acquire)) {}
+	m_Latencies.Push(nanoseconds / double(ops));
+	m_Lock.clear(std::memory_order::release);
+
+	m_Ops.fetch_add(ops, std::memory_order::relaxed);
+	m_Nanoseconds.fetch_add(u64(nanoseconds), std::memory_order::relaxed);
+}
+
+void BenchmarkState::SampleMemory()
+{
+	u64 memory = GetResidentMemory();
+	u64 peak = m_PeakMemory.load(std::memory_order::relaxed);
+	while (memory > peak && !m_PeakMemory.compare_exchange_weak(peak, memory, std::memory_order::relaxed)) {}
+}
+
+static std::string_view ToView(StringRef ref) { return { reinterpret_cast<const char*>(ref.Data()), ref.Size() }; }
+
+BenchmarkRunner::BenchmarkRunner(StringRef filter, double scale) : m_Filter(filter), m_Scale(scale)
+{
+	fmt::print("{:<16} {:<22} {:>14} {:>12} {:>24} {:>12}\n", "Workload", "Allocator", "ops/s", "mean (ns)",
+		"p99 of batch mean (ns)", "RSS (MB)");
+}
+
+void BenchmarkRunner::Run(StringRef workload, StringRef allocator, Allocator& alloc, BenchmarkFunction function)
+{
+	std::string_view filter = ToView(m_Filter);
+	if (!filter.empty() && ToView(workload).find(filter) == std::string_view::npos &&
+		ToView(allocator).find(filter) == std::string_view::npos)
+	{
+		return;
+	}
+
+	BenchmarkState state(alloc, m_Scale);
+	u64 baseline = GetResidentMemory();
+
+	function(state);
+
+	// Only the time spent in timed batches counts, not the setup of the workload.
+	u64 ops = state.m_Ops.load();
+	double mean = double(state.m_Nanoseconds.load()) / double(ops);
+	double opsPerSecond = 1e9 / mean;
+
+	// Batches are timed as a whole, so this is the p99 of the mean latency of a batch, not of single operations.
+	double p99 = 0.0;
+	Array<double>& latencies = state.m_Latencies;
+	if (latencies.Size())
+	{
+		double* nth = latencies.Data() + latencies.Size() * 99 / 100;
+		std::nth_element(latencies.Data(), nth, latencies.Data() + latencies.Size());
+		p99 = *nth;
+	}
+
+	// Memory the allocator kept from earlier runs is not counted, so run one allocator at a time for exact numbers.
+	u64 peak = state.m_PeakMemory.load();
+	double memory = peak > baseline ? double(peak - baseline) / (1024.0 * 1024.0) : 0.0;
+
+	fmt::print("{:<16} {:<22} {:>14.0f} {:>12.1f} {:>24.1f} {:>12.1f}\n", ToView(workload), ToView(allocator),
+		opsPerSecond, mean, p99, memory);
+}
+
+u64 GetResidentMemory()
+{
+#ifdef PLATFORM_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+
+	return counters.WorkingSetSize;
+#elif defined(PLATFORM_LINUX)
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (!file)
+	{
+		return 0;
+	}
+
+	unsigned long long size = 0, resident = 0;
+	int read = fscanf(file, "%llu %llu", &size, &resident);
+	fclose(file);
+
+	return read == 2 ? u64(resident) * u64(sysconf(_SC_PAGESIZE)) : 0;
+#else
+	return 0;
+#endif
+}
+
+}
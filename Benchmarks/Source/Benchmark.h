@@ -0,0 +1,112 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Minimal benchmark harness.
+
+#pragma once
+#include <atomic>
+#include <chrono>
+
+#include "Core/Memory/Allocator.h"
+#include "Core/Types/Array.h"
+#include "Core/Types/String.h"
+
+namespace Ignis {
+
+/// Allocator that forwards to malloc, as the baseline to compare against.
+class MallocAllocator : public Allocator
+{
+public:
+	void* Allocate(u64 size) override;
+	void* Allocate(u64 size, u64 alignment) override;
+	void Deallocate(void* ptr) override;
+	using Allocator::Deallocate;
+	u64 GrowAllocation(void*, u64 oldSize, u64) override { return oldSize; }
+};
+
+/// Allocator the harness keeps its own data in, such as recorded latencies, so that it doesn't disturb the allocator
+/// measured.
+extern MallocAllocator GMallocAlloc;
+
+/// Times batches of operations of a single benchmark run.
+/// Operations are timed in batches rather than one by one, as reading the clock costs about as much as an allocation.
+/// Latencies are reported per operation, averaged over a batch, and throughput only counts time spent in batches.
+/// The reported p99 is the p99 of those batch means, so a single slow operation is spread over its whole batch.
+class BenchmarkState
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// Construct a BenchmarkState.
+	///
+	/// \param alloc Allocator being measured.
+	/// \param scale Multiplier for the amount of work, below 1 for quick runs.
+	BenchmarkState(Allocator& alloc, double scale);
+
+	/// Scale a number of operations by the scale of the run.
+	///
+	/// \param count Number of operations in a full run.
+	///
+	/// \return Number of operations to run, at least 1.
+	u64 Scaled(u64 count) const;
+
+	/// Record a batch of operations that started at start and ended now. Thread safe.
+	///
+	/// \param start Time the batch started at.
+	/// \param ops Number of operations in the batch.
+	void Record(Clock::time_point start, u64 ops);
+
+	/// Record the resident memory of the process, if it is the highest seen during the run.
+	/// Call at the point the workload has the most memory live.
+	void SampleMemory();
+
+	/// Allocator being measured.
+	Allocator& Alloc;
+
+private:
+	friend class BenchmarkRunner;
+
+	double m_Scale;
+	std::atomic_flag m_Lock = ATOMIC_FLAG_INIT;
+	Array<double> m_Latencies{ GMallocAlloc };
+	std::atomic<u64> m_Ops = 0;
+	std::atomic<u64> m_Nanoseconds = 0;
+	std::atomic<u64> m_PeakMemory = 0;
+};
+
+/// A workload to run against every allocator.
+using BenchmarkFunction = void (*)(BenchmarkState& state);
+
+/// Runs workloads against allocators, and prints a table of results.
+class BenchmarkRunner
+{
+public:
+	/// Construct a BenchmarkRunner.
+	///
+	/// \param filter Only workloads or allocators with this in their name are run. Empty runs everything.
+	/// \param scale Multiplier for the amount of work.
+	BenchmarkRunner(StringRef filter, double scale);
+
+	/// Run a workload against an allocator, and print the results.
+	///
+	/// \param workload Name of the workload.
+	/// \param allocator Name of the allocator.
+	/// \param alloc The allocator.
+	/// \param function The workload.
+	void Run(StringRef workload, StringRef allocator, Allocator& alloc, BenchmarkFunction function);
+
+private:
+	StringRef m_Filter;
+	double m_Scale;
+};
+
+/// Get the resident memory of the process.
+///
+/// \return The resident memory in bytes, or 0 if the platform doesn't support it.
+u64 GetResidentMemory();
+
+/// Run every allocator benchmark.
+///
+/// \param runner Runner to run them with.
+void RunAllocatorBenchmarks(BenchmarkRunner& runner);
+
+}
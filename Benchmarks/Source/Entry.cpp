@@ -0,0 +1,32 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include <string_view>
+
+#include "Benchmark.h"
+#include "Core/Platform/Entry.h"
+
+using namespace Ignis;
+
+/// Usage: IgnisBenchmarks [--quick] [filter]
+/// --quick runs a tenth of the work, and filter only runs workloads or allocators with it in their name.
+int Entry(StringRef invocation, ArrayRef<StringRef> arguments)
+{
+	StringRef filter;
+	double scale = 1.0;
+	for (StringRef argument : arguments)
+	{
+		if (std::string_view(reinterpret_cast<const char*>(argument.Data()), argument.Size()) == "--quick")
+		{
+			scale = 0.1;
+		}
+		else
+		{
+			filter = argument;
+		}
+	}
+
+	BenchmarkRunner runner(filter, scale);
+	RunAllocatorBenchmarks(runner);
+
+	return 0;
+}
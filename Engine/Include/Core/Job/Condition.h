@@ -3,6 +3,7 @@
 /// A wake condition for a sleeping job.
 
 #pragma once
+#include "Core/Platform/Platform.h"
 
 namespace Ignis {
 
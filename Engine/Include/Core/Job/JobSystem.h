@@ -3,6 +3,8 @@
 /// Ignis Job System. He's your best buddy.
 
 #pragma once
+#include <atomic>
+
 #include "Core/Types/Array.h"
 #include "Core/Job/Condition.h"
 #include "Core/Job/Job.h"
@@ -11,12 +13,49 @@ namespace Ignis {
 
 namespace JobSystem {
 
+/// How submitted jobs are executed.
+enum class ExecutionMode
+{
+	/// Jobs are distributed across the worker threads.
+	Parallel,
+
+	/// Jobs are executed inline on the submitting thread, in an order shuffled by a seed.
+	/// The same seed and submissions always give the same execution order, and there is no scheduling overhead,
+	/// which makes it useful for profiling the cost of the jobs themselves.
+	Deterministic
+};
+
+/// Condition returned by Submit(), satisfied once every job of the submission has finished.
+/// Completion counters are recycled, so it remembers the generation of the counter it was handed, and stays
+/// satisfied after the counter is reused for another submission.
+class IGNIS_API Completion : public WaitCondition
+{
+public:
+	/// Constructor.
+	///
+	/// \param state Counter state, with the generation in the high 32 bits and the jobs left in the low 32 bits.
+	/// \param generation Generation of the counter when the jobs were submitted.
+	Completion(const std::atomic<u64>* state, u32 generation) : m_State(state), m_Generation(generation) {}
+
+	operator bool() const override;
+
+	void SleepOn() const override;
+
+private:
+	const std::atomic<u64>* m_State;
+	u32 m_Generation;
+};
+
 /// Initialize the job system, with the current thread as the main thread.
 ///
 /// \param threadCount Number of worker threads to spawn.
 /// If 0, is set to the maximum number of concurrent threads supported by the hardware - 1.
+/// Ignored in ExecutionMode::Deterministic, where no worker threads are spawned.
 /// \param memUsage Memory to use for Fiber stacks, in MB. Defaults to 100 MB.
-IGNIS_API void Initialize(u16 threadCount = 0, u64 memUsage = 100);
+/// \param mode How to execute submitted jobs. Defaults to ExecutionMode::Parallel.
+/// \param seed Seed for the execution order in ExecutionMode::Deterministic.
+IGNIS_API void Initialize(
+	u16 threadCount = 0, u64 memUsage = 100, ExecutionMode mode = ExecutionMode::Parallel, u64 seed = 0);
 
 /// Submit a list of jobs to the job system.
 /// Use this when you're submitting jobs and doing some more work before waiting for them to complete.
@@ -25,7 +64,7 @@ IGNIS_API void Initialize(u16 threadCount = 0, u64 memUsage = 100);
 /// Must survive until all jobs have finished execution, as no copies are made.
 /// 
 /// \return Condition to wait on for the jobs to complete.
-IGNIS_API const WaitCondition& Submit(ArrayRef<Job> jobs);
+IGNIS_API Completion Submit(ArrayRef<Job> jobs);
 
 /// Pause the current job until a condition becomes true.
 ///
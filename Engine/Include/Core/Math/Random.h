@@ -13,4 +13,12 @@ namespace Ignis {
 /// \return A 64-bit random integer.
 u64 IGNIS_API QuickRandom();
 
+/// Quickly generate a random number from a caller-owned state, for reproducible sequences.
+/// Same generator as QuickRandom().
+///
+/// \param state State of the generator. MUST NOT be 0. Is advanced by the call.
+///
+/// \return A 64-bit random integer.
+u64 IGNIS_API QuickRandom(u64& state);
+
 }
@@ -21,11 +21,27 @@ public:
 	/// \return Pointer to the first byte allocated.
 	virtual void* Allocate(u64 size) = 0;
 
+	/// Allocate memory with a specific alignment.
+	///
+	/// \param size The number of bytes to allocate.
+	/// \param alignment Alignment of the allocation, in bytes. Must be a power of 2.
+	///
+	/// \return Pointer to the first byte allocated. Is freed with Deallocate like any other allocation.
+	virtual void* Allocate(u64 size, u64 alignment) = 0;
+
 	/// Deallocate memory allocated by the allocator.
 	///
 	/// \param ptr The pointer returned from Allocate.
 	virtual void Deallocate(void* ptr) = 0;
 
+	/// Deallocate memory allocated by the allocator, when the owner knows its size.
+	/// Allocators that would otherwise have to look the size up override this.
+	/// Allocations with an alignment of more than 16 bytes must use the unsized overload.
+	///
+	/// \param ptr The pointer returned from Allocate.
+	/// \param size Size passed to Allocate, or returned from the last GrowAllocation.
+	virtual void Deallocate(void* ptr, [[maybe_unused]] u64 size) { Deallocate(ptr); }
+
 	/// Grow an allocation in place.
 	///
 	/// \param ptr The pointer returned from Allocate.
@@ -36,4 +52,8 @@ public:
 	virtual u64 GrowAllocation(void* ptr, u64 oldSize, u64 newSize) = 0;
 };
 
+/// Global default allocator, used by everything that isn't given an allocator.
+/// Is GCacheAlloc, or GRawAlloc if IGNIS_THREAD_CACHE_ALLOCATOR is turned off.
+extern IGNIS_API Allocator& GAlloc;
+
 }
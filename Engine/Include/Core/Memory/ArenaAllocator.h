@@ -0,0 +1,71 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Linear arena allocator.
+
+#pragma once
+#include "Core/Memory/Allocator.h"
+
+namespace Ignis {
+
+/// Allocator that bumps a pointer through large chunks of memory.
+/// Deallocate does nothing, all memory is reclaimed at once with Reset(), making it ideal for per-frame data.
+/// The most recent allocation can be grown in place, so an Array that is the last thing allocated never copies.
+///
+/// \warning Not thread safe.
+class IGNIS_API ArenaAllocator : public Allocator
+{
+public:
+	/// Construct an ArenaAllocator. Does not allocate any memory until the first allocation.
+	///
+	/// \param chunkSize Size of each chunk, in bytes. Allocations larger than this get a chunk to themselves.
+	/// \param alloc Allocator to allocate chunks from. Defaults to GAlloc.
+	ArenaAllocator(u64 chunkSize = 1024 * 1024, Allocator& alloc = GAlloc);
+
+	ArenaAllocator(const ArenaAllocator& other) = delete;
+
+	/// Destructor. Frees all chunks.
+	~ArenaAllocator();
+
+	void* Allocate(u64 size) override;
+	void* Allocate(u64 size, u64 alignment) override;
+
+	/// Does nothing, memory is only reclaimed by Reset().
+	void Deallocate(void* ptr) override;
+	using Allocator::Deallocate;
+
+	/// Grows the allocation in place if it was the most recent one, and there is space left in its chunk.
+	u64 GrowAllocation(void* ptr, u64 oldSize, u64 newSize) override;
+
+	/// Free every allocation at once. The current chunk is kept around to be reused.
+	void Reset();
+
+	/// Get the number of bytes handed out since the last Reset(), including alignment padding.
+	///
+	/// \return The number of bytes.
+	u64 GetUsed() const;
+
+private:
+	/// Header at the start of every chunk. Chunks are kept in a list from newest to oldest.
+	struct Chunk
+	{
+		Chunk* Next;
+		u64 Size;
+	};
+
+	/// Allocate a chunk and make it the current one.
+	///
+	/// \param size Usable size of the chunk.
+	///
+	/// \return If the chunk was allocated. The current chunk is left as it was if not.
+	bool NewChunk(u64 size);
+
+	Allocator* m_Alloc = nullptr;
+	Chunk* m_Chunk = nullptr;
+	u8* m_Current = nullptr;
+	u8* m_End = nullptr;
+	u8* m_Last = nullptr;
+	u64 m_ChunkSize = 0;
+	u64 m_Used = 0;
+};
+
+}
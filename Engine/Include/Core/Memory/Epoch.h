@@ -0,0 +1,94 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Epoch-based reclamation of memory shared with lock-free readers.
+
+#pragma once
+#include <atomic>
+
+#include "Core/Types/Array.h"
+
+namespace Ignis {
+
+/// Defers freeing memory until no lock-free reader can still be looking at it.
+/// Readers hold a Guard while they follow pointers into shared memory. Writers unlink memory so that new readers can't
+/// reach it, and then Retire() it. Retired memory is freed once every Guard that was alive when it was retired is gone.
+///
+/// Readers are counted in a few cache-line sized stripes picked by thread, so entering and leaving is a single atomic
+/// add on a line that is mostly not shared.
+/// Guards must not be held across anything that can block, such as waiting on a job, as that holds up reclamation.
+class IGNIS_API EpochDomain
+{
+public:
+	/// Keeps memory retired while it is alive from being freed.
+	class IGNIS_API Guard
+	{
+	public:
+		/// Construct a Guard.
+		///
+		/// \param domain Domain to guard.
+		Guard(const EpochDomain& domain);
+
+		Guard(const Guard& other) = delete;
+
+		~Guard();
+
+	private:
+		std::atomic<u64>* m_Counter;
+	};
+
+	/// Frees retired memory.
+	///
+	/// \param ptr Memory to free.
+	/// \param context Context passed to Retire().
+	using Deleter = void (*)(void* ptr, void* context);
+
+	/// Construct an EpochDomain.
+	///
+	/// \param alloc Allocator to use for the list of retired memory. Defaults to GAlloc.
+	EpochDomain(Allocator& alloc = GAlloc);
+
+	EpochDomain(const EpochDomain& other) = delete;
+
+	/// Destructor. Frees all retired memory, so no Guards may be alive.
+	~EpochDomain();
+
+	/// Free memory once no reader can be looking at it anymore. Thread safe.
+	///
+	/// \param ptr Memory to free. Must already be unreachable for new readers.
+	/// \param deleter Function that frees the memory.
+	/// \param context Context to pass to the deleter.
+	void Retire(void* ptr, Deleter deleter, void* context);
+
+	/// Free any retired memory that no reader can be looking at anymore. Called every few retires, so it is only needed
+	/// to clean up after the last writes.
+	void Reclaim();
+
+private:
+	struct Retired
+	{
+		void* Ptr;
+		Deleter Free;
+		void* Context;
+		u64 Epoch;
+	};
+
+	struct alignas(64) Stripe
+	{
+		std::atomic<u64> Count;
+	};
+
+	static constexpr u64 StripeCount = 16;
+
+	/// Number of retires between attempts to reclaim.
+	static constexpr u64 ReclaimInterval = 64;
+
+	/// Readers are counted by the parity of the epoch they entered in.
+	mutable Stripe m_Readers[2][StripeCount] = {};
+	std::atomic<u64> m_Epoch = 0;
+
+	std::atomic_flag m_Lock;
+	Array<Retired> m_Retired;
+	u64 m_SinceReclaim = 0;
+};
+
+}
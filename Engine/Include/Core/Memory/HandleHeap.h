@@ -0,0 +1,191 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Compacting heap of objects addressed by handles.
+
+#pragma once
+#include <atomic>
+
+#include "Core/Job/JobSystem.h"
+#include "Core/Types/Array.h"
+
+namespace Ignis {
+
+/// Handle to an object in a HandleHeap.
+/// Handles stay valid when the object is moved, and go stale when it is freed, even if the slot is reused.
+struct HeapHandle
+{
+	/// Index of the slot in the handle table.
+	u32 Index = 0;
+
+	/// Generation of the slot when the handle was made. 0 is never a valid generation.
+	u32 Generation = 0;
+
+	/// Check if the handle was ever assigned, not if it is still alive. Use HandleHeap::IsValid() for that.
+	explicit operator bool() const { return Generation != 0; }
+
+	bool operator==(const HeapHandle& other) const = default;
+};
+
+/// Heap for long-lived objects that are reached through handles, so that they can be moved to defragment it.
+/// Objects are allocated at the end of a single reserved region, and Compact() incrementally slides live objects
+/// down over the holes left by freed ones, decommitting the memory it frees up.
+/// This keeps memory bounded for long sessions with lots of churn, and keeps live objects packed for iteration.
+///
+/// Objects are moved with MemCopy(), so they must be trivially relocatable: no pointers into themselves.
+/// Pointers from Get() are only stable until the next compaction step, so don't hold on to them across frames.
+///
+/// Allocation, deallocation and compaction are thread safe. If compaction can run while another thread uses objects,
+/// that thread must hold a ReadScope while it uses the pointers it got from Get().
+class IGNIS_API HandleHeap
+{
+public:
+	/// Keeps compaction from moving objects while it is alive.
+	/// Other ReadScopes, Get(), and IsValid() are still allowed.
+	/// Allocating or freeing while holding one deadlocks.
+	class ReadScope
+	{
+	public:
+		/// Construct a ReadScope.
+		///
+		/// \param heap Heap to keep from compacting.
+		ReadScope(const HandleHeap& heap);
+
+		ReadScope(const ReadScope& other) = delete;
+
+		~ReadScope();
+
+	private:
+		const HandleHeap& m_Heap;
+	};
+
+	/// Construct a HandleHeap. Reserves address space, but only commits memory as it is used.
+	///
+	/// \param capacity Largest the heap can grow to, in bytes.
+	/// \param alloc Allocator for the handle table. Defaults to GAlloc.
+	HandleHeap(u64 capacity = u64(1) << 32, Allocator& alloc = GAlloc);
+
+	HandleHeap(const HandleHeap& other) = delete;
+
+	/// Destructor. Releases all memory. Any compaction job must have finished.
+	~HandleHeap();
+
+	/// Allocate an object. Objects are aligned to 16 bytes.
+	///
+	/// \param size Size of the object, in bytes.
+	///
+	/// \return Handle to the object, which evaluates to false if the heap is full.
+	HeapHandle Allocate(u64 size);
+
+	/// Free an object. Does nothing if the handle is stale.
+	///
+	/// \param handle Handle to the object.
+	void Deallocate(HeapHandle handle);
+
+	/// Get the current address of an object.
+	///
+	/// \param handle Handle to the object.
+	///
+	/// \return The address, or nullptr if the handle is stale.
+	void* Get(HeapHandle handle) const;
+
+	/// Check if a handle refers to a live object.
+	///
+	/// \param handle The handle.
+	///
+	/// \return If the object is alive.
+	bool IsValid(HeapHandle handle) const;
+
+	/// Run a step of compaction, moving at most maxBytes of objects.
+	/// A pass of compaction starts at the first hole, and ends by decommitting the memory after the last live object.
+	///
+	/// \param maxBytes Most bytes to move in this step, so that a step doesn't stall readers for too long.
+	///
+	/// \return If there is nothing left to compact.
+	bool Compact(u64 maxBytes = 1024 * 1024);
+
+	/// Submit a job to the JobSystem that runs a single Compact() step.
+	/// Only one compaction job can be in flight, wait on the returned condition before submitting another.
+	///
+	/// \param maxBytes Most bytes to move in the step.
+	///
+	/// \return Condition to wait on for the step to finish.
+	JobSystem::Completion CompactAsync(u64 maxBytes = 1024 * 1024);
+
+	/// Get the number of bytes taken up by live objects, including their headers.
+	///
+	/// \return The number of bytes.
+	u64 GetLive() const;
+
+	/// Get the number of bytes from the start of the heap to the end of the last object, including holes.
+	///
+	/// \return The number of bytes.
+	u64 GetUsed() const;
+
+private:
+	/// Header right before every object.
+	struct Block
+	{
+		/// Handle table slot of the object, or FreeSlot if the block has been freed.
+		u32 Slot;
+		u32 Padding;
+
+		/// Size of the block, including the header.
+		u64 Size;
+	};
+
+	/// Entry in the handle table.
+	struct Slot
+	{
+		/// Offset of the object from the start of the heap, or the next free slot if the slot is free.
+		u64 Offset;
+
+		/// Incremented every time the slot is freed, so that old handles go stale.
+		u32 Generation;
+
+		bool Live;
+	};
+
+	static constexpr u32 FreeSlot = u32(-1);
+
+	void LockShared() const;
+	void UnlockShared() const;
+	void Lock();
+	void Unlock();
+
+	/// IsValid() for callers that already hold the lock, shared or exclusive.
+	bool IsValidLocked(HeapHandle handle) const;
+
+	bool Reserve(u64 top);
+	void RunCompaction(AnyRef);
+
+	u8* m_Base = nullptr;
+	u64 m_Capacity = 0;
+	u64 m_Committed = 0;
+
+	/// End of the last block.
+	u64 m_Top = 0;
+
+	/// Bytes in live blocks.
+	u64 m_Live = 0;
+
+	/// Lowest hole in the heap, or m_Top if there is none.
+	u64 m_FirstHole = 0;
+
+	/// Compaction pass in progress. Everything below m_Destination is packed,
+	/// [m_Destination, m_Scan) is free, and everything from m_Scan onwards hasn't been looked at yet.
+	bool m_Compacting = false;
+	u64 m_Destination = 0;
+	u64 m_Scan = 0;
+
+	Array<Slot> m_Slots;
+	u32 m_FreeSlots = FreeSlot;
+
+	/// Number of ReadScopes, with the top bit set while the heap is locked exclusively.
+	mutable std::atomic<u32> m_Lock = 0;
+
+	Private::MCallable<void(AnyRef), HandleHeap> m_CompactCallable;
+	Job m_CompactJob;
+	u64 m_StepBytes = 0;
+};
+
+}
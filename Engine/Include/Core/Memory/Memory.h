@@ -17,6 +17,13 @@ namespace Ignis {
 /// \param size Number of bytes to copy.
 void IGNIS_API MemCopy(void* destination, const void* source, u64 size);
 
+/// Copy from one location to another, where the locations may overlap.
+///
+/// \param destination Destination for the copy.
+/// \param source Source for the copy.
+/// \param size Number of bytes to copy.
+void IGNIS_API MemMove(void* destination, const void* source, u64 size);
+
 /// Set all bytes to a specific value.
 ///
 /// \param destination Destination for the set.
@@ -33,6 +40,44 @@ void IGNIS_API MemSet(void* destination, Byte value, u64 size);
 /// \return If both regions of memory are equal.
 bool IGNIS_API MemCompare(const void* first, const void* second, u64 size);
 
+/// Size from which the streaming variants bypass the cache. Smaller operations are done with MemCopy() and MemSet().
+constexpr u64 StreamingThreshold = 256 * 1024;
+
+/// Copy from one location to another with non-temporal stores, which write around the cache.
+/// Use for large copies that won't be read again soon, such as snapshots, so that they don't evict the working set.
+/// Only bypasses the cache on x64, and is MemCopy() everywhere else.
+///
+/// \param destination Destination for the copy. Must not overlap the source.
+/// \param source Source for the copy.
+/// \param size Number of bytes to copy.
+void IGNIS_API MemCopyStreaming(void* destination, const void* source, u64 size);
+
+/// Set all bytes to a specific value with non-temporal stores, which write around the cache.
+/// Only bypasses the cache on x64, and is MemSet() everywhere else.
+///
+/// \param destination Destination for the set.
+/// \param value Value to set each byte.
+/// \param size Number of bytes to set.
+void IGNIS_API MemSetStreaming(void* destination, Byte value, u64 size);
+
+/// Find the first occurrence of a byte. Uses AVX2 if the CPU supports it.
+///
+/// \param ptr Memory to search.
+/// \param value Byte to search for.
+/// \param size Number of bytes to search.
+///
+/// \return Pointer to the first occurrence, or nullptr if there is none.
+IGNIS_API const void* MemFind(const void* ptr, Byte value, u64 size);
+
+/// Count the occurrences of a byte. Uses AVX2 if the CPU supports it.
+///
+/// \param ptr Memory to search.
+/// \param value Byte to count.
+/// \param size Number of bytes to search.
+///
+/// \return The number of occurrences.
+u64 IGNIS_API MemCount(const void* ptr, Byte value, u64 size);
+
 /// Construct an object at a memory location.
 ///
 /// \tparam T Type of object to construct.
@@ -46,7 +91,22 @@ T* Construct(void* at, Args&&... args)
 	return new (at) T(static_cast<Args&&>(args)...);
 }
 
+namespace Private {
+
+/// Header stored right before every object allocated with New<T>().
+struct NewHeader
+{
+	/// Allocator the object was allocated from.
+	Allocator* Alloc;
+
+	/// Offset from the start of the allocation to the object.
+	u64 Offset;
+};
+
+}
+
 /// Allocate memory for an object from an allocator, and construct it.
+/// The object is aligned to at least 16 bytes, or alignof(T) if it is stronger.
 ///
 /// \tparam T Type of object to construct.
 /// \param alloc Allocator to use.
@@ -56,9 +116,46 @@ T* Construct(void* at, Args&&... args)
 template<typename T, typename... Args>
 T* New(Allocator& alloc, Args&&... args)
 {
-	auto ptr = alloc.Allocate(sizeof(Allocator*) + sizeof(T));
-	*reinterpret_cast<Allocator**>(ptr) = &alloc;
-	return Construct<T>(reinterpret_cast<Allocator*>(ptr) + 1, static_cast<Args&&>(args)...);
+	constexpr u64 offset = alignof(T) > sizeof(Private::NewHeader) ? alignof(T) : sizeof(Private::NewHeader);
+	auto ptr = reinterpret_cast<u8*>(alloc.Allocate(offset + sizeof(T), offset));
+	*(reinterpret_cast<Private::NewHeader*>(ptr + offset) - 1) = { &alloc, offset };
+	return Construct<T>(ptr + offset, static_cast<Args&&>(args)...);
+}
+
+/// Allocate memory for an object from an allocator, and construct it, without a header.
+/// Unlike New<T>(), the owner must remember the allocator, and free the object with Destroy() as the same type.
+///
+/// \tparam T Type of object to construct.
+/// \param alloc Allocator to use.
+/// \param args Arguments to pass to the constructor.
+///
+/// \return Pointer to the constructed object.
+template<typename T, typename... Args>
+T* Create(Allocator& alloc, Args&&... args)
+{
+	return Construct<T>(alloc.Allocate(sizeof(T), alignof(T)), static_cast<Args&&>(args)...);
+}
+
+/// Destroy an object allocated with Create<T>(), and free its memory with a sized deallocation.
+///
+/// \tparam T Type of the object. Must be the type it was created with.
+/// \param alloc Allocator the object was created with.
+/// \param object Object to destroy.
+template<typename T>
+void Destroy(Allocator& alloc, T* object)
+{
+	if (object)
+	{
+		object->~T();
+		if constexpr (alignof(T) > 16)
+		{
+			alloc.Deallocate(object);
+		}
+		else
+		{
+			alloc.Deallocate(object, sizeof(T));
+		}
+	}
 }
 
 /// Delete an object allocated with New<T>().
@@ -70,9 +167,9 @@ void Delete(T* object)
 {
 	if (object)
 	{
+		auto header = *(reinterpret_cast<Private::NewHeader*>(object) - 1);
 		object->~T();
-		auto ptr = reinterpret_cast<Allocator*>(object) - 1;
-		ptr->Deallocate(ptr + 1);
+		header.Alloc->Deallocate(reinterpret_cast<u8*>(object) - header.Offset);
 	}
 }
 
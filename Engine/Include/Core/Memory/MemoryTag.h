@@ -0,0 +1,39 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Memory tags, which attribute allocations to subsystems.
+
+#pragma once
+#include "Core/Memory/Allocator.h"
+
+namespace Ignis {
+
+/// Subsystem an allocation is attributed to.
+/// Tags from User up to MaxMemoryTags are free for applications, and can be named with MemoryTracking::SetTagName().
+enum class MemoryTag : u8
+{
+	Untagged,
+	Job,
+	Containers,
+	Strings,
+	Log,
+	Reflection,
+	User
+};
+
+/// Number of memory tags, including user tags.
+constexpr u64 MaxMemoryTags = 32;
+
+namespace MemoryTracking {
+
+/// Get the shared allocator for a tag, which allocates from GAlloc.
+/// If IGNIS_MEMORY_TRACKING is turned off, is GAlloc itself and nothing is tracked.
+/// Containers default to the allocator of MemoryTag::Containers, and strings to the one of MemoryTag::Strings.
+///
+/// \param tag Tag to get the allocator of.
+///
+/// \return The allocator.
+IGNIS_API Allocator& GetAllocator(MemoryTag tag);
+
+}
+
+}
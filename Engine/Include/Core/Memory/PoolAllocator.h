@@ -0,0 +1,416 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Lock-free fixed-size pool allocator.
+
+#pragma once
+#include <atomic>
+
+#include "Core/Memory/Allocator.h"
+#include "Core/Misc/Assert.h"
+#include "Core/Platform/Thread.h"
+
+namespace Ignis {
+
+/// Allocator for many small objects of the same size, such as nodes of lists and trees.
+///
+/// Free blocks are kept in magazines: chains of up to MagazineSize blocks, linked through their first bytes, so a free
+/// block only needs room for a pointer.
+/// Every thread holds two magazines it allocates from and frees into without any synchronization,
+/// and only exchanges full magazines with a shared lock-free stack, one compare-exchange per magazine.
+/// The stack holds magazine descriptors, which live outside of the blocks, and uses tagged pointers to avoid ABA.
+/// Threads past MaxCachedThreads share a single lock-free free list of blocks instead.
+/// When the pool runs dry, it grows by page-sized slabs.
+/// Memory is only returned to the parent allocator when the pool is destroyed.
+///
+/// \tparam Size Size of each block, in bytes.
+/// \tparam Align Alignment of each block, in bytes. Must be a power of 2.
+template<u64 Size, u64 Align = 16>
+class PoolAllocator : public Allocator
+{
+private:
+	struct FreeBlock
+	{
+		/// Next block in the same magazine or free list.
+		FreeBlock* Next;
+	};
+
+	struct Magazine
+	{
+		/// Next magazine on the same stack.
+		Magazine* Next;
+
+		/// First block of the magazine.
+		FreeBlock* Blocks;
+
+		/// Number of blocks in the magazine.
+		u64 Count;
+	};
+
+	static_assert((Align & (Align - 1)) == 0, "Align must be a power of 2");
+
+public:
+	/// Size of each block, after making room for the free list and aligning.
+	static constexpr u64 BlockSize = ((Size > sizeof(FreeBlock) ? Size : sizeof(FreeBlock)) + Align - 1) & ~(Align - 1);
+
+	/// Number of blocks in a full magazine.
+	static constexpr u64 MagazineSize = 32;
+
+	/// Number of threads that get their own magazines. Any other threads go to the shared free list directly.
+	static constexpr u64 MaxCachedThreads = 64;
+
+	/// Size of each slab the pool grows by.
+	static constexpr u64 SlabSize = (BlockSize * MagazineSize + 4095) & ~u64(4095);
+
+	/// Construct a PoolAllocator. Does not allocate any memory until the first allocation.
+	///
+	/// \param alloc Allocator to allocate slabs from. Defaults to GAlloc.
+	PoolAllocator(Allocator& alloc = GAlloc) : m_Alloc(&alloc) {}
+
+	PoolAllocator(const PoolAllocator& other) = delete;
+
+	/// Destructor. Frees every slab, so all blocks must have been deallocated or abandoned.
+	~PoolAllocator()
+	{
+		while (m_Slabs)
+		{
+			Slab* next = m_Slabs->Next;
+			m_Alloc->Deallocate(m_Slabs);
+			m_Slabs = next;
+		}
+	}
+
+	/// Allocate a block.
+	///
+	/// \param size Size of the allocation. Must not be more than Size.
+	///
+	/// \return Pointer to a block of BlockSize bytes. nullptr if the pool couldn't grow.
+	void* Allocate(u64 size) override
+	{
+		IASSERT(size <= Size, "Allocation is too large for the PoolAllocator");
+
+		Magazines* magazines = GetMagazines();
+		if (!magazines)
+		{
+			if (FreeBlock* block = PopStack<FreeBlock>(m_FreeBlocks))
+			{
+				return block;
+			}
+
+			// Keep the first block and hand the rest of the magazine to the free list.
+			Magazine* magazine = PopMagazine();
+			if (!magazine)
+			{
+				return nullptr;
+			}
+
+			FreeBlock* block = magazine->Blocks;
+			if (block->Next)
+			{
+				PushStack(m_FreeBlocks, block->Next, LastBlock(block->Next));
+			}
+			PushStack(m_EmptyMagazines, magazine, magazine);
+
+			return block;
+		}
+
+		if (!magazines->Loaded)
+		{
+			if (magazines->Previous)
+			{
+				magazines->Loaded = magazines->Previous;
+				magazines->LoadedCount = magazines->PreviousCount;
+				magazines->Previous = nullptr;
+				magazines->PreviousCount = 0;
+			}
+			else
+			{
+				// Blocks can end up on the free list if a magazine couldn't be allocated for them.
+				Magazine* magazine = PopMagazine();
+				if (!magazine)
+				{
+					return PopStack<FreeBlock>(m_FreeBlocks);
+				}
+
+				magazines->Loaded = magazine->Blocks;
+				magazines->LoadedCount = magazine->Count;
+				PushStack(m_EmptyMagazines, magazine, magazine);
+			}
+		}
+
+		FreeBlock* block = magazines->Loaded;
+		magazines->Loaded = block->Next;
+		magazines->LoadedCount--;
+
+		return block;
+	}
+
+	/// Allocate a block.
+	///
+	/// \param size Size of the allocation. Must not be more than Size.
+	/// \param alignment Alignment of the allocation. Must not be more than Align.
+	///
+	/// \return Pointer to a block of BlockSize bytes. nullptr if the pool couldn't grow.
+	void* Allocate(u64 size, u64 alignment) override
+	{
+		IASSERT(alignment <= Align, "Alignment is too large for the PoolAllocator");
+		return Allocate(size);
+	}
+
+	/// Deallocate a block allocated by this pool.
+	///
+	/// \param ptr The pointer returned from Allocate.
+	void Deallocate(void* ptr) override
+	{
+		if (!ptr)
+		{
+			return;
+		}
+
+		auto block = reinterpret_cast<FreeBlock*>(ptr);
+		Magazines* magazines = GetMagazines();
+		if (!magazines)
+		{
+			PushStack(m_FreeBlocks, block, block);
+			return;
+		}
+
+		if (magazines->LoadedCount == MagazineSize)
+		{
+			// Previous is always either full or empty.
+			if (magazines->Previous)
+			{
+				if (Magazine* magazine = NewMagazine())
+				{
+					magazine->Blocks = magazines->Previous;
+					magazine->Count = magazines->PreviousCount;
+					PushStack(m_FullMagazines, magazine, magazine);
+				}
+				else
+				{
+					// Out of memory for a magazine, so give the blocks to the free list instead of losing them.
+					PushStack(m_FreeBlocks, magazines->Previous, LastBlock(magazines->Previous));
+				}
+			}
+
+			magazines->Previous = magazines->Loaded;
+			magazines->PreviousCount = magazines->LoadedCount;
+			magazines->Loaded = nullptr;
+			magazines->LoadedCount = 0;
+		}
+
+		block->Next = magazines->Loaded;
+		magazines->Loaded = block;
+		magazines->LoadedCount++;
+	}
+
+	/// Every block has the same size, so the size is not needed.
+	using Allocator::Deallocate;
+
+	/// Blocks cannot grow past BlockSize.
+	u64 GrowAllocation(void* ptr, u64 oldSize, u64) override { return ptr ? BlockSize : oldSize; }
+
+private:
+	struct alignas(64) Magazines
+	{
+		FreeBlock* Loaded = nullptr;
+		FreeBlock* Previous = nullptr;
+		u64 LoadedCount = 0;
+		u64 PreviousCount = 0;
+	};
+
+	struct Slab
+	{
+		Slab* Next;
+	};
+
+	/// Number of magazines carved out of each slab of blocks.
+	static constexpr u64 SlabMagazines = (SlabSize / BlockSize + MagazineSize - 1) / MagazineSize;
+
+	/// Offset of the first block in a slab, past the slab header and its magazines.
+	static constexpr u64 SlabBlocks = (sizeof(Slab) + SlabMagazines * sizeof(Magazine) + Align - 1) & ~(Align - 1);
+
+	/// Number of magazines in a slab that only holds magazines.
+	static constexpr u64 MagazineSlabCount = (4096 - sizeof(Slab)) / sizeof(Magazine);
+
+	static constexpr u64 AddressMask = (u64(1) << 48) - 1;
+
+	template<typename T>
+	static T* Address(u64 tagged)
+	{
+		return reinterpret_cast<T*>(tagged & AddressMask);
+	}
+
+	static u64 Tag(void* ptr, u64 previous) { return (u64(ptr) & AddressMask) | ((previous >> 48) + 1) << 48; }
+
+	Magazines* GetMagazines()
+	{
+		u32 index = Thread::GetCurrentIndex();
+		return index < MaxCachedThreads ? &m_Magazines[index] : nullptr;
+	}
+
+	/// Pop the top of a lock-free stack.
+	///
+	/// \return The popped element. nullptr if the stack is empty.
+	template<typename T>
+	static T* PopStack(std::atomic<u64>& stack)
+	{
+		u64 head = stack.load(std::memory_order::acquire);
+		while (T* top = Address<T>(head))
+		{
+			// top may have been popped and reused by now, but slabs are never freed so the read is safe,
+			// and the tag makes the exchange fail.
+			if (stack.compare_exchange_weak(
+					head, Tag(top->Next, head), std::memory_order::acq_rel, std::memory_order::acquire))
+			{
+				return top;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/// Push a chain of elements linked through Next onto a lock-free stack.
+	template<typename T>
+	static void PushStack(std::atomic<u64>& stack, T* first, T* last)
+	{
+		u64 head = stack.load(std::memory_order::relaxed);
+		do
+		{
+			last->Next = Address<T>(head);
+		} while (!stack.compare_exchange_weak(
+			head, Tag(first, head), std::memory_order::release, std::memory_order::relaxed));
+	}
+
+	/// Get the last block of a chain.
+	static FreeBlock* LastBlock(FreeBlock* block)
+	{
+		while (block->Next)
+		{
+			block = block->Next;
+		}
+
+		return block;
+	}
+
+	/// Pop a full magazine, growing the pool if there are none.
+	///
+	/// \return The magazine. nullptr if the pool couldn't grow.
+	Magazine* PopMagazine()
+	{
+		while (true)
+		{
+			if (Magazine* magazine = PopStack<Magazine>(m_FullMagazines))
+			{
+				return magazine;
+			}
+
+			if (!Grow())
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	/// Get an unused magazine descriptor, allocating more if there are none.
+	///
+	/// \return The magazine. nullptr if no more could be allocated.
+	Magazine* NewMagazine()
+	{
+		while (true)
+		{
+			if (Magazine* magazine = PopStack<Magazine>(m_EmptyMagazines))
+			{
+				return magazine;
+			}
+
+			while (m_GrowLock.test_and_set(std::memory_order::acquire)) {}
+
+			Slab* slab = AddSlab(4096);
+			if (!slab)
+			{
+				m_GrowLock.clear(std::memory_order::release);
+				return nullptr;
+			}
+
+			auto magazines = reinterpret_cast<Magazine*>(slab + 1);
+			for (u64 i = 0; i + 1 < MagazineSlabCount; i++)
+			{
+				magazines[i].Next = &magazines[i + 1];
+			}
+			PushStack(m_EmptyMagazines, magazines, magazines + MagazineSlabCount - 1);
+
+			m_GrowLock.clear(std::memory_order::release);
+		}
+	}
+
+	/// Allocate a slab and add it to the list of slabs to free. m_GrowLock must be held.
+	///
+	/// \return The slab. nullptr if it couldn't be allocated.
+	Slab* AddSlab(u64 size)
+	{
+		constexpr u64 alignment = Align > alignof(Magazine) ? Align : alignof(Magazine);
+		auto slab = reinterpret_cast<Slab*>(m_Alloc->Allocate(size, alignment));
+		if (!slab)
+		{
+			return nullptr;
+		}
+
+		slab->Next = m_Slabs;
+		m_Slabs = slab;
+		return slab;
+	}
+
+	/// Add a slab of full magazines, unless another thread already did.
+	///
+	/// \return If there are full magazines now. false if the slab couldn't be allocated.
+	bool Grow()
+	{
+		while (m_GrowLock.test_and_set(std::memory_order::acquire)) {}
+
+		// Someone else might have grown the pool while we were waiting.
+		if (Address<Magazine>(m_FullMagazines.load(std::memory_order::acquire)))
+		{
+			m_GrowLock.clear(std::memory_order::release);
+			return true;
+		}
+
+		// The slab holds its own magazines, so growing never runs out of them.
+		Slab* slab = AddSlab(SlabBlocks + SlabSize);
+		if (!slab)
+		{
+			m_GrowLock.clear(std::memory_order::release);
+			return false;
+		}
+
+		auto magazines = reinterpret_cast<Magazine*>(slab + 1);
+		u8* data = reinterpret_cast<u8*>(slab) + SlabBlocks;
+		u64 count = SlabSize / BlockSize;
+		for (u64 first = 0; first < count; first += MagazineSize)
+		{
+			u64 last = first + MagazineSize < count ? first + MagazineSize : count;
+			for (u64 i = first; i < last; i++)
+			{
+				reinterpret_cast<FreeBlock*>(data + i * BlockSize)->Next =
+					i + 1 < last ? reinterpret_cast<FreeBlock*>(data + (i + 1) * BlockSize) : nullptr;
+			}
+
+			Magazine* magazine = &magazines[first / MagazineSize];
+			magazine->Blocks = reinterpret_cast<FreeBlock*>(data + first * BlockSize);
+			magazine->Count = last - first;
+			PushStack(m_FullMagazines, magazine, magazine);
+		}
+
+		m_GrowLock.clear(std::memory_order::release);
+		return true;
+	}
+
+	Allocator* m_Alloc = nullptr;
+	Slab* m_Slabs = nullptr;
+	std::atomic_flag m_GrowLock;
+	alignas(64) std::atomic<u64> m_FullMagazines = 0;
+	alignas(64) std::atomic<u64> m_EmptyMagazines = 0;
+	alignas(64) std::atomic<u64> m_FreeBlocks = 0;
+	Magazines m_Magazines[MaxCachedThreads];
+};
+
+}
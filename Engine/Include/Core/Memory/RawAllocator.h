@@ -3,20 +3,58 @@
 /// Raw system memory allocator.
 
 #pragma once
+#include <atomic>
+
 #include "Core/Memory/Allocator.h"
+#include "Core/Platform/VirtualMemory.h"
 
 namespace Ignis {
 
 /// Allocator that directly allocates system memory.
+///
+/// Small allocations come from the C heap. Allocations of at least MapThreshold bytes get their own virtual memory
+/// mapping, with address space reserved past the end of the allocation, so GrowAllocation can grow them in place by
+/// committing more pages instead of copying. On Linux, a mapping whose reservation runs out is extended with mremap
+/// if the address space after it is free.
+///
+/// Mapped allocations can be backed by huge pages, which cuts down on TLB misses in large tables.
 class IGNIS_API RawAllocator : public Allocator
 {
 public:
 	void* Allocate(u64 size) override;
+	void* Allocate(u64 size, u64 alignment) override;
 	void Deallocate(void* ptr) override;
+	using Allocator::Deallocate;
+
+	/// Grows mapped allocations in place. Heap allocations never grow.
 	u64 GrowAllocation(void* ptr, u64 oldSize, u64 newSize) override;
+
+	/// Smallest allocation that gets its own mapping, in bytes.
+	static constexpr u64 MapThreshold = 256 * 1024;
+
+	/// Smallest amount of address space reserved for a mapped allocation, in bytes.
+	static constexpr u64 MinReservation = 16 * 1024 * 1024;
+
+	/// Back allocations of at least VirtualMemory::GetHugePageSize() bytes with huge pages. Off by default.
+	/// Explicit huge pages are tried first, which can't grow in place, then transparent huge pages.
+	///
+	/// \param use If huge pages should be used for allocations made from now on.
+	void SetUseHugePages(bool use);
+
+	/// Get the huge pages an allocation was given, or requested for it in the case of transparent huge pages.
+	///
+	/// \param ptr The pointer returned from Allocate.
+	///
+	/// \return The huge pages of the allocation. Always None for allocations smaller than MapThreshold.
+	VirtualMemory::HugePages GetHugePages(void* ptr) const;
+
+private:
+	void* AllocateMapped(u64 size, u64 alignment);
+
+	std::atomic<bool> m_UseHugePages = false;
 };
 
 /// Global Raw Allocator for allocating memory directly on the heap.
-extern IGNIS_API RawAllocator GAlloc;
+extern IGNIS_API RawAllocator GRawAlloc;
 
 }
@@ -0,0 +1,112 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// LIFO stack allocator.
+
+#pragma once
+#include "Core/Memory/Allocator.h"
+
+namespace Ignis {
+
+/// Allocator that hands out memory in last-in, first-out order, for nested temporary buffers.
+/// Deallocating the most recent allocation gives its memory back right away, and everything allocated after a marker
+/// can be freed at once with FreeToMarker() or a Scope. The most recent allocation can be grown in place.
+///
+/// Memory comes from a single reservation of address space that is committed as the stack grows,
+/// so pointers stay valid until they are freed.
+///
+/// \warning Not thread safe.
+class IGNIS_API StackAllocator : public Allocator
+{
+public:
+	/// Position in the stack to free back to.
+	struct Marker
+	{
+		u8* Top;
+		u8* Last;
+	};
+
+	/// Frees everything allocated during its lifetime when it goes out of scope.
+	class Scope
+	{
+	public:
+		/// Construct a Scope.
+		///
+		/// \param alloc Stack to free back to its current top.
+		Scope(StackAllocator& alloc) : m_Alloc(alloc), m_Marker(alloc.GetMarker()) {}
+
+		Scope(const Scope& other) = delete;
+
+		~Scope() { m_Alloc.FreeToMarker(m_Marker); }
+
+	private:
+		StackAllocator& m_Alloc;
+		Marker m_Marker;
+	};
+
+	/// Construct a StackAllocator. Reserves address space, but only commits memory as it is used.
+	///
+	/// \param capacity Largest the stack can grow to, in bytes.
+	StackAllocator(u64 capacity = 256 * 1024 * 1024);
+
+	StackAllocator(const StackAllocator& other) = delete;
+
+	/// Destructor. Releases all memory.
+	~StackAllocator();
+
+	/// Asserts if the stack is full, and returns nullptr if asserts are disabled or committing memory fails.
+	void* Allocate(u64 size) override;
+	void* Allocate(u64 size, u64 alignment) override;
+
+	/// Frees the allocation right away if it is the most recent one.
+	/// Anything else is marked as freed, and given back once every allocation after it has been freed too.
+	void Deallocate(void* ptr) override;
+	using Allocator::Deallocate;
+
+	/// Grows the allocation in place if it is the most recent one.
+	u64 GrowAllocation(void* ptr, u64 oldSize, u64 newSize) override;
+
+	/// Get the current top of the stack.
+	///
+	/// \return Marker to pass to FreeToMarker().
+	Marker GetMarker() const;
+
+	/// Free everything allocated after a marker was taken.
+	///
+	/// \param marker Marker returned from GetMarker(). Must not have been freed past already.
+	void FreeToMarker(Marker marker);
+
+	/// Give the memory above the top of the stack back to the OS.
+	void Trim();
+
+	/// Get the number of bytes in use, including headers and alignment padding.
+	///
+	/// \return The number of bytes.
+	u64 GetUsed() const;
+
+private:
+	/// Header right before every allocation.
+	struct Header
+	{
+		/// The allocation before this one, with FreedBit set once this one has been freed while not on top.
+		u8* Previous;
+
+		/// Top of the stack before this allocation.
+		u8* Start;
+	};
+
+	/// Allocations are aligned to 16 bytes, so the low bit of Header::Previous is free to use.
+	static constexpr u64 FreedBit = 1;
+
+	/// Pop allocations off the top that were freed while they weren't on top.
+	void PopFreed();
+
+	bool Reserve(u8* end);
+
+	u8* m_Base = nullptr;
+	u8* m_Top = nullptr;
+	u8* m_Last = nullptr;
+	u64 m_Committed = 0;
+	u64 m_Capacity = 0;
+};
+
+}
@@ -0,0 +1,115 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Allocation tracking and memory budgets per subsystem.
+
+#pragma once
+#include "Core/Memory/Allocator.h"
+#include "Core/Memory/MemoryTag.h"
+#include "Core/Types/String.h"
+
+namespace Ignis {
+
+/// Statistics of a memory tag.
+struct MemoryTagStats
+{
+	/// Bytes currently allocated.
+	u64 Live;
+
+	/// Highest Live has ever been.
+	u64 Peak;
+
+	/// Number of allocations currently alive.
+	u64 Count;
+
+	/// Number of allocations ever made.
+	u64 Total;
+
+	/// Budget of the tag in bytes, or 0 if it has none.
+	u64 Budget;
+};
+
+/// Allocator that attributes every allocation to a memory tag, and allocates from another allocator.
+/// Stores a 16 byte header before every allocation. Debug builds grow the header to also record the call site of
+/// every live allocation, for the leak report.
+///
+/// Statistics are kept per tag, so any number of TaggedAllocators can share a tag.
+/// Use MemoryTracking::GetAllocator() instead of creating one, unless the parent allocator has to be different.
+class IGNIS_API TaggedAllocator : public Allocator
+{
+public:
+	/// Construct a TaggedAllocator.
+	///
+	/// \param tag Tag to attribute allocations to.
+	/// \param alloc Allocator to allocate from. Defaults to GAlloc.
+	TaggedAllocator(MemoryTag tag, Allocator& alloc = GAlloc);
+
+	void* Allocate(u64 size) override;
+	void* Allocate(u64 size, u64 alignment) override;
+	void Deallocate(void* ptr) override;
+
+	/// The size is in the header already, so the size is not needed.
+	using Allocator::Deallocate;
+
+	u64 GrowAllocation(void* ptr, u64 oldSize, u64 newSize) override;
+
+	/// Get the tag of the allocator.
+	///
+	/// \return The tag.
+	MemoryTag GetTag() const { return m_Tag; }
+
+private:
+	void* Allocate(u64 size, u64 alignment, void* callSite);
+
+	MemoryTag m_Tag;
+	Allocator* m_Alloc;
+};
+
+namespace MemoryTracking {
+
+/// Called when a tag goes over its budget. Called once every time it crosses the budget, not for every allocation.
+///
+/// \param tag The tag over budget.
+/// \param live Bytes allocated by the tag, including the allocation that crossed the budget.
+/// \param budget Budget of the tag.
+using BudgetHandler = void (*)(MemoryTag tag, u64 live, u64 budget);
+
+/// Get the statistics of a tag.
+///
+/// \param tag Tag to get the statistics of.
+///
+/// \return The statistics.
+IGNIS_API MemoryTagStats GetStats(MemoryTag tag);
+
+/// Name a user tag.
+///
+/// \param tag Tag to name.
+/// \param name Name of the tag. Must be valid until the end of the program.
+IGNIS_API void SetTagName(MemoryTag tag, const char* name);
+
+/// Get the name of a tag.
+///
+/// \param tag Tag to get the name of.
+///
+/// \return The name. User tags without a name are called User.
+IGNIS_API StringRef GetTagName(MemoryTag tag);
+
+/// Set a budget for a tag.
+///
+/// \param tag Tag to set the budget of.
+/// \param budget Budget in bytes. 0 removes the budget.
+IGNIS_API void SetBudget(MemoryTag tag, u64 budget);
+
+/// Set the function called when a tag goes over its budget. The default handler logs a warning.
+///
+/// \param handler The handler.
+IGNIS_API void SetBudgetHandler(BudgetHandler handler);
+
+/// Log every tag with allocations still alive, and in debug builds, the call site of each allocation.
+/// Is called automatically at shutdown.
+///
+/// \return Number of allocations still alive.
+IGNIS_API u64 ReportLeaks();
+
+}
+
+}
@@ -0,0 +1,102 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// General purpose allocator with size classes and per-thread caches.
+
+#pragma once
+#include <atomic>
+
+#include "Core/Memory/Allocator.h"
+
+namespace Ignis {
+
+/// General purpose allocator with size classes and per-thread caches.
+///
+/// Small allocations are rounded up to a size class, and served from a cache owned by the calling thread without any
+/// synchronization. Caches refill from, and overflow into, central per-class free lists in batches, so a block freed
+/// on a different thread than the one that allocated it (producer-consumer) costs one lock per batch instead of one
+/// per free.
+///
+/// Small blocks are carved out of spans aligned to their size, with a header at the start of the span,
+/// so the size class of any pointer is found by masking it. Large allocations get a span to themselves, and the
+/// largest ones are mapped by GRawAlloc so they can grow in place.
+///
+/// A thread's cache is flushed when it exits, so the allocator must outlive every thread that uses it.
+class IGNIS_API ThreadCacheAllocator : public Allocator
+{
+public:
+	void* Allocate(u64 size) override;
+
+	/// Alignments up to 64 bytes are served from size classes, anything stronger gets its own span.
+	/// Alignment must not be more than half of SpanSize.
+	void* Allocate(u64 size, u64 alignment) override;
+
+	void Deallocate(void* ptr) override;
+
+	/// Small allocations find their size class from the size instead of reading the span header.
+	void Deallocate(void* ptr, u64 size) override;
+
+	u64 GrowAllocation(void* ptr, u64 oldSize, u64 newSize) override;
+
+	/// Return every block cached by the calling thread to the central free lists.
+	/// Done automatically when a thread exits.
+	void FlushThreadCache();
+
+	/// Size and alignment of a span, in bytes.
+	static constexpr u64 SpanSize = 64 * 1024;
+
+	/// Size of the header at the start of every span. Keeps blocks cache line aligned.
+	static constexpr u64 SpanHeaderSize = 64;
+
+	/// Largest allocation served from a size class. Anything bigger gets its own span.
+	static constexpr u64 MaxSmallSize = 8 * 1024;
+
+	/// Number of size classes. 16 byte steps up to 128 bytes, then 4 steps per power of 2.
+	static constexpr u64 ClassCount = 32;
+
+	/// Number of threads that get a cache. Threads with a higher Thread::GetCurrentIndex() use the central lists.
+	static constexpr u64 MaxCachedThreads = 64;
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* Next;
+	};
+
+	struct alignas(64) ThreadCache
+	{
+		FreeBlock* Lists[ClassCount] = {};
+		u32 Counts[ClassCount] = {};
+
+		/// If the thread using the cache has registered to flush it when it exits.
+		bool Registered = false;
+	};
+
+	struct alignas(64) CentralList
+	{
+		std::atomic_flag Lock;
+		FreeBlock* Head = nullptr;
+	};
+
+	void* AllocateLarge(u64 size, u64 alignment);
+	void DeallocateSmall(void* ptr, u64 sizeClass);
+	ThreadCache* GetCache();
+	void Flush(ThreadCache* cache);
+	void ExitThread();
+
+	/// Take blocks from the central list. count is set to the number of blocks taken, which is less than asked for if
+	/// memory runs out.
+	FreeBlock* Fetch(u64 sizeClass, u64& count);
+
+	void Release(u64 sizeClass, FreeBlock* first, FreeBlock* last);
+	bool CarveSpan(u64 sizeClass);
+
+	friend struct ThreadCacheFlusher;
+
+	ThreadCache m_Caches[MaxCachedThreads];
+	CentralList m_Central[ClassCount];
+};
+
+/// Global thread-caching allocator. The default engine allocator unless IGNIS_THREAD_CACHE_ALLOCATOR is turned off.
+extern IGNIS_API ThreadCacheAllocator GCacheAlloc;
+
+}
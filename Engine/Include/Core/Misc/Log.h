@@ -2,9 +2,11 @@
 /// \file
 /// Logging.
 
+#pragma once
 #include <cstdlib>
 #include <mutex>
 
+#include "Core/Memory/TaggedAllocator.h"
 #include "Core/Misc/Format.h"
 #include "Core/Types/Array.h"
 #include "Core/Types/Pointer.h"
@@ -32,13 +34,16 @@ public:
 	virtual ~LogSink() = default;
 
 	virtual void Sink(LogLevel level, StringRef message) = 0;
+
+	/// Write out any buffered messages. Called at shutdown, as sinks are never destroyed.
+	virtual void Flush() {}
 };
 
 /// Singleton for logging.
 class IGNIS_API Logger
 {
 public:
-	/// Get the singleton.
+	/// Get the singleton. It is never destroyed, so logging works until the very end of static destruction.
 	///
 	/// \return The Logger singleton.
 	static Logger* Get();
@@ -50,11 +55,16 @@ public:
 	/// \param UniquePtr of the sink to move.
 	void AddSink(UniquePtr<LogSink>&& sink);
 
+	/// Flush every sink. Called automatically at shutdown.
+	void Flush();
+
 	/// Log a message. Don't use, use the ILOG macro instead.
 	template<typename... Args>
 	void Log(StringRef category, LogLevel level, StringRef message, Args&&... args)
 	{
-		String fmtString = "[{:02d}:{:02d}:{:02d}:{:03d}][{}] {}: " + message;
+		String fmtString(*m_Alloc);
+		fmtString += "[{:02d}:{:02d}:{:02d}:{:03d}][{}] {}: ";
+		fmtString += message;
 		auto time = Time::Now();
 		String log = Format(fmtString, time.Hour, time.Minute, time.Second, time.Millisecond, LevelToString(level),
 			category, static_cast<Args&&>(args)...);
@@ -74,9 +84,8 @@ private:
 
 	StringRef LevelToString(LogLevel level);
 
-	static Logger* s_Logger;
-
-	Array<UniquePtr<LogSink>> m_Sinks;
+	Allocator* m_Alloc;
+	SmallArray<UniquePtr<LogSink>, 4> m_Sinks;
 };
 
 /// A category for logging. Use the ILOG_CATEGORY macros below.
@@ -102,6 +111,7 @@ class IGNIS_API StdoutSink : public LogSink
 {
 public:
 	void Sink(LogLevel level, StringRef message) override;
+	void Flush() override;
 };
 
 class IGNIS_API DebugSink : public LogSink
@@ -25,7 +25,7 @@ int wmain(int argc, wchar_t** argv)
 	String invocation = PlatformInternals::ConvToUTF8(argv[0]);
 
 	Array<String> argData;
-	Array<StringRef> args;
+	SmallArray<StringRef, 8> args;
 	argData.Reserve(argc - 1);
 	args.Reserve(argc - 1);
 	for (int i = 1; i < argc; i++)
@@ -44,7 +44,7 @@ int main(int argc, char** argv)
 
 	StringRef invocation = argv[0];
 
-	Array<StringRef> args;
+	SmallArray<StringRef, 8> args;
 	args.Reserve(argc - 1);
 	for (int i = 1; i < argc; i++)
 	{
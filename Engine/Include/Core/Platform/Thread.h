@@ -34,6 +34,14 @@ public:
 
 	static u16 GetMaxThreads();
 
+	/// Get a small index unique among the running threads.
+	/// Indices are handed out densely from 0, and the index of a thread is reused by a later thread once it exits,
+	/// so per-thread slots in a fixed-size array must be cleaned up by a thread_local destructor, which runs before
+	/// the index is handed back as long as it was constructed after the first call to this.
+	///
+	/// \return The index of the calling thread.
+	static u32 GetCurrentIndex();
+
 private:
 	void* m_PlatformHandle = nullptr;
 	u64 m_ID = 0;
@@ -0,0 +1,123 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Reserving and committing virtual memory.
+
+#pragma once
+#include "Core/Types/BaseTypes.h"
+
+namespace Ignis {
+
+namespace VirtualMemory {
+
+/// Access allowed to committed pages.
+enum class Protection
+{
+	None,
+	Read,
+	ReadWrite,
+	ReadExecute
+};
+
+/// Kind of huge pages backing a region.
+enum class HugePages
+{
+	/// Normal pages.
+	None,
+
+	/// The OS was asked to back the region with transparent huge pages, such as on Linux. The OS only grants them when
+	/// it has free huge pages, so parts of the region may still be backed by normal pages.
+	TransparentRequested,
+
+	/// The region is made of huge pages, such as Linux MAP_HUGETLB or Windows large pages.
+	Explicit
+};
+
+/// Reserve address space, without backing it with memory. Reserved pages can't be accessed until they are committed.
+///
+/// \param size Number of bytes to reserve. Rounded up to the page size.
+///
+/// \return Start of the reserved region, aligned to the page size. nullptr if the address space couldn't be reserved.
+IGNIS_API void* Reserve(u64 size);
+
+/// Reserve address space starting at a multiple of an alignment larger than the page size, such as the huge page size.
+///
+/// \param size Number of bytes to reserve. Rounded up to the page size.
+/// \param alignment Alignment of the start of the region. Must be a power of 2.
+///
+/// \return Start of the reserved region. Release it with Release() like a region from Reserve(). nullptr if the
+/// address space couldn't be reserved.
+IGNIS_API void* ReserveAligned(u64 size, u64 alignment);
+
+/// Commit reserved pages, making them readable and writable.
+/// Memory is only backed by physical pages on first touch, and committed pages read as zero until written.
+///
+/// \param ptr Start of the pages to commit. Must be aligned to the page size, and inside a reserved region.
+/// \param size Number of bytes to commit. Rounded up to the page size.
+///
+/// \return If the pages were committed.
+IGNIS_API bool Commit(void* ptr, u64 size);
+
+/// Decommit pages, giving their memory back to the OS but keeping the address space reserved.
+/// The contents of the pages are lost.
+///
+/// \param ptr Start of the pages to decommit. Must be aligned to the page size.
+/// \param size Number of bytes to decommit. Rounded up to the page size.
+IGNIS_API void Decommit(void* ptr, u64 size);
+
+/// Release a reserved region, and any committed pages in it.
+///
+/// \param ptr Start of the region, as returned from Reserve().
+/// \param size Size of the region, as passed to Reserve(), or ExtendReservation() if it was extended.
+IGNIS_API void Release(void* ptr, u64 size);
+
+/// Change the access allowed to committed pages.
+///
+/// \param ptr Start of the pages. Must be aligned to the page size.
+/// \param size Number of bytes to change. Rounded up to the page size.
+/// \param protection Access to allow.
+///
+/// \return If the protection was changed.
+IGNIS_API bool Protect(void* ptr, u64 size, Protection protection);
+
+/// Try to extend a reserved region in place, if the address space right after it is free.
+/// Only supported on Linux, where the whole region must be committed. Always fails on other platforms.
+///
+/// \param ptr Start of the region, as returned from Reserve().
+/// \param oldSize Current size of the region.
+/// \param newSize Size to extend the region to. The new pages are committed.
+///
+/// \return If the region was extended.
+IGNIS_API bool ExtendReservation(void* ptr, u64 oldSize, u64 newSize);
+
+/// Reserve and commit a region made of explicit huge pages.
+/// The pages are taken from a pool the OS has set aside, so this fails if the pool is too small.
+/// On Windows, the process needs the SeLockMemoryPrivilege.
+///
+/// \param size Number of bytes to commit. Must be a multiple of the huge page size.
+///
+/// \return Start of the region, aligned to the huge page size. Free with Release(). nullptr if there weren't enough
+/// huge pages.
+IGNIS_API void* CommitHuge(u64 size);
+
+/// Ask the OS to back a region with transparent huge pages. Only the parts of the region that cover whole aligned
+/// huge pages can get them, and the OS is free to ignore the request.
+///
+/// \param ptr Start of the region. Must be aligned to the page size.
+/// \param size Size of the region.
+///
+/// \return If the OS took the advice. Always false on platforms without transparent huge pages.
+IGNIS_API bool AdviseHugePages(void* ptr, u64 size);
+
+/// Get the size of a page.
+///
+/// \return The page size, in bytes.
+IGNIS_API u64 GetPageSize();
+
+/// Get the size of a huge page.
+///
+/// \return The huge page size, in bytes. 0 if the platform has no huge pages.
+IGNIS_API u64 GetHugePageSize();
+
+}
+
+}
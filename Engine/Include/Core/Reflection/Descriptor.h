@@ -3,6 +3,7 @@
 /// Descriptors for reflectable types.
 
 #pragma once
+#include "Core/Memory/TaggedAllocator.h"
 #include "Core/Types/Array.h"
 #include "Core/Types/Map.h"
 #include "Core/Types/Pair.h"
@@ -269,10 +270,10 @@ struct ClassDescriptor : TypeDescriptor
 	ClassDescriptor(StringRef name, u64 size) : TypeDescriptor(name, size) {}
 
 	/// Public members of the class or struct.
-	HashMap<StringRef, ClassMember> PublicMembers;
+	HashMap<StringRef, ClassMember> PublicMembers { MemoryTracking::GetAllocator(MemoryTag::Reflection) };
 
 	/// Private and protected members of the class or struct.
-	HashMap<StringRef, ClassMember> PrivateMembers;
+	HashMap<StringRef, ClassMember> PrivateMembers { MemoryTracking::GetAllocator(MemoryTag::Reflection) };
 
 	/// The class or struct derived from. Multiple inheritance is NOT supported , which is why only one parent pointer
 	/// exists.
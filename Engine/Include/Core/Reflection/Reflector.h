@@ -70,7 +70,7 @@ public:
 		auto member = m_Descriptor->PublicMembers.Get(name);
 		if (member)
 		{
-			reinterpret_cast<T*>(reinterpret_cast<u8*>(m_Object) + member->Offset);
+			return reinterpret_cast<T*>(reinterpret_cast<u8*>(m_Object) + member->Offset);
 		}
 
 		return nullptr;
@@ -6,6 +6,7 @@
 #include <initializer_list>
 
 #include "Core/Memory/Memory.h"
+#include "Core/Memory/MemoryTag.h"
 #include "Core/Memory/RawAllocator.h"
 #include "Core/Misc/Assert.h"
 #include "Core/Types/Traits.h"
@@ -69,7 +70,7 @@ public:
 	const T* end() const { return m_Data + m_Size; }
 
 private:
-	const T* m_Data = nullptr;
+	T* m_Data = nullptr;
 	u64 m_Size = 0;
 };
 
@@ -101,6 +102,45 @@ bool operator!=(ArrayRef<T> first, ArrayRef<T> second)
 	return !(first == second);
 }
 
+namespace Private {
+
+/// Move elements to uninitialized memory, destroying the originals. The ranges may overlap.
+///
+/// \param destination Where to move the elements to.
+/// \param source Elements to move.
+/// \param count Number of elements.
+template<typename T>
+void Relocate(T* destination, T* source, u64 count)
+{
+	if (destination == source || !count)
+	{
+		return;
+	}
+
+	if constexpr (Traits::IsTriviallyRelocatable<T>::value)
+	{
+		MemMove(destination, source, count * sizeof(T));
+	}
+	else if (destination < source)
+	{
+		for (u64 i = 0; i < count; i++)
+		{
+			Construct<T>(destination + i, std::move(source[i]));
+			source[i].~T();
+		}
+	}
+	else
+	{
+		for (u64 i = count; i > 0; i--)
+		{
+			Construct<T>(destination + i - 1, std::move(source[i - 1]));
+			source[i - 1].~T();
+		}
+	}
+}
+
+}
+
 /// Dynamically resizing array.
 ///
 /// \tparam T Type to hold in the array.
@@ -108,77 +148,48 @@ template<typename T>
 class Array
 {
 public:
-	/// Construct an Array with an allocator.
+	/// Construct an Array with an allocator. Does not allocate until the first element is added.
 	///
-	/// \param alloc Allocator to use for memory allocation. Defaults to the Raw Allocator.
-	Array(Allocator& alloc = GAlloc) : m_Alloc(&alloc)
-	{
-		m_Data = reinterpret_cast<T*>(m_Alloc->Allocate(sizeof(T) * 2));
-		m_Size = 0;
-		m_Capacity = 2;
-	}
+	/// \param alloc Allocator to use for memory allocation. Defaults to the allocator of MemoryTag::Containers.
+	Array(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Alloc(&alloc) {}
 
 	/// Create an Array from an ArrayRef.
 	///
 	/// \param ref ArrayRef to create the string from.
-	/// \param alloc Allocator to use for memory allocation. Defaults to the Raw Allocator.
-	Array(ArrayRef<T> ref, Allocator& alloc = GAlloc) : m_Alloc(&alloc)
+	/// \param alloc Allocator to use for memory allocation. Defaults to the allocator of MemoryTag::Containers.
+	Array(ArrayRef<T> ref, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Alloc(&alloc)
 	{
-		m_Data = reinterpret_cast<T*>(m_Alloc->Allocate(sizeof(T) * ref.Size()));
-		m_Size = ref.Size();
-		m_Capacity = ref.Size();
-
-		// Copy elements
-		for (u64 index = 0; auto& elem : ref)
-		{
-			Construct<T>(m_Data + index, elem);
-			index++;
-		}
+		Append(ref);
 	}
 
 	/// Create an Array with a size.
 	///
 	/// \param size The size of the Array.
-	/// \param alloc Allocator to use for memory allocation. Defaults to the Raw Allocator.
+	/// \param alloc Allocator to use for memory allocation. Defaults to the allocator of MemoryTag::Containers.
 	///
 	/// \warning This should only be used if you are writing directly to the Array's buffer with Data().
-	Array(u64 size, Allocator& alloc = GAlloc) : m_Alloc(&alloc)
+	Array(u64 size, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Alloc(&alloc)
 	{
-		m_Data = reinterpret_cast<T*>(m_Alloc->Allocate(sizeof(T) * size));
+		m_Data = reinterpret_cast<T*>(m_Alloc->Allocate(sizeof(T) * size, alignof(T)));
 		m_Size = size;
 		m_Capacity = size;
 	}
 
-	Array(const std::initializer_list<T>& list, Allocator& alloc = GAlloc) : m_Alloc(&alloc)
+	Array(const std::initializer_list<T>& list, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Alloc(&alloc)
 	{
-		m_Data = reinterpret_cast<T*>(m_Alloc->Allocate(sizeof(T) * list.size()));
-		m_Size = list.size();
-		m_Capacity = list.size();
-
-		for (u64 i = 0; const auto& elem : list)
+		Realloc(list.size());
+		for (const auto& elem : list)
 		{
-			Construct<T>(m_Data + i, elem);
-
-			i++;
+			Construct<T>(m_Data + m_Size++, elem);
 		}
 	}
 
 	/// Copy constructor.
 	///
 	/// \param other Array to copy.
-	Array(const Array& other) : m_Alloc(other.m_Alloc)
-	{
-		m_Data = reinterpret_cast<T*>(m_Alloc->Allocate(sizeof(T) * other.m_Size));
-		m_Size = other.m_Size;
-		m_Capacity = other.m_Capacity;
-
-		// Copy elements
-		for (u64 index = 0; auto& elem : other)
-		{
-			Construct<T>(m_Data + index, elem);
-			index++;
-		}
-	}
+	Array(const Array& other) : m_Alloc(other.m_Alloc) { Append(ArrayRef<T>(other.m_Data, other.m_Size)); }
 
 	/// Move constructor.
 	///
@@ -189,6 +200,8 @@ public:
 		m_Size = other.m_Size;
 		m_Capacity = other.m_Capacity;
 		other.m_Data = nullptr;
+		other.m_Size = 0;
+		other.m_Capacity = 0;
 	}
 
 	/// Destructor.
@@ -213,20 +226,10 @@ public:
 	/// \param other Array to copy.
 	Array& operator=(const Array& other)
 	{
-		// Destroy objects
-		for (auto& elem : *this)
+		if (this != &other)
 		{
-			elem.~T();
-		}
-		m_Size = 0;
-		Realloc(other.m_Size);
-		m_Size = other.m_Size;
-
-		// Copy elements
-		for (u64 index = 0; auto& elem : other)
-		{
-			Construct<T>(m_Data + index, elem);
-			index++;
+			Clear();
+			Append(ArrayRef<T>(other.m_Data, other.m_Size));
 		}
 
 		return *this;
@@ -237,6 +240,11 @@ public:
 	/// \param other Array to move.
 	Array& operator=(Array&& other)
 	{
+		if (this == &other)
+		{
+			return *this;
+		}
+
 		this->~Array<T>();
 
 		m_Alloc = other.m_Alloc;
@@ -244,6 +252,8 @@ public:
 		m_Size = other.m_Size;
 		m_Capacity = other.m_Capacity;
 		other.m_Data = nullptr;
+		other.m_Size = 0;
+		other.m_Capacity = 0;
 
 		return *this;
 	}
@@ -288,6 +298,11 @@ public:
 	/// \return The number of elements.
 	u64 Size() const { return m_Size; }
 
+	/// Get the number of elements the Array can hold without reallocating.
+	///
+	/// \return The capacity.
+	u64 Capacity() const { return m_Capacity; }
+
 	/// Reserve space in the Array.
 	///
 	/// \param size The number of elements to reserve space for.
@@ -333,7 +348,170 @@ public:
 		return *ptr;
 	}
 
-	/// Clear the Array, destroying all elements.
+	/// Copy elements to the end of the Array, reallocating at most once.
+	///
+	/// \param elements Elements to copy. Must not be from this Array.
+	void Append(ArrayRef<T> elements) { InsertRange(m_Size, elements); }
+
+	/// Copy elements into the Array, moving the elements after them back.
+	///
+	/// \param index Index to insert the first element at. Can be Size() to append.
+	/// \param elements Elements to copy. Must not be from this Array.
+	void InsertRange(u64 index, ArrayRef<T> elements)
+	{
+		IASSERT(index <= m_Size, "Out of bounds insert in Array");
+		IASSERT(elements.Data() + elements.Size() <= m_Data || elements.Data() >= m_Data + m_Size,
+			"Cannot insert elements of an Array into itself");
+
+		u64 count = elements.Size();
+		if (!count)
+		{
+			return;
+		}
+
+		Realloc(m_Size + count);
+		Private::Relocate(m_Data + index + count, m_Data + index, m_Size - index);
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			MemCopy(m_Data + index, elements.Data(), count * sizeof(T));
+		}
+		else
+		{
+			for (u64 i = 0; i < count; i++)
+			{
+				Construct<T>(m_Data + index + i, elements[i]);
+			}
+		}
+		m_Size += count;
+	}
+
+	/// Insert a copy of an object, moving the elements after it back.
+	///
+	/// \param index Index to insert the object at. Can be Size() to push.
+	/// \param object Object to insert. Must not be from this Array.
+	///
+	/// \return Reference to the object in the Array.
+	T& Insert(u64 index, const T& object)
+	{
+		IASSERT(index <= m_Size, "Out of bounds insert in Array");
+
+		Realloc(m_Size + 1);
+		Private::Relocate(m_Data + index + 1, m_Data + index, m_Size - index);
+		auto ptr = Construct<T>(m_Data + index, object);
+		m_Size++;
+		return *ptr;
+	}
+
+	/// Insert an object, moving the elements after it back.
+	///
+	/// \param index Index to insert the object at. Can be Size() to push.
+	/// \param object Object to insert. Must not be from this Array.
+	///
+	/// \return Reference to the object in the Array.
+	T& Insert(u64 index, T&& object)
+	{
+		IASSERT(index <= m_Size, "Out of bounds insert in Array");
+
+		Realloc(m_Size + 1);
+		Private::Relocate(m_Data + index + 1, m_Data + index, m_Size - index);
+		auto ptr = Construct<T>(m_Data + index, std::move(object));
+		m_Size++;
+		return *ptr;
+	}
+
+	/// Remove an element, moving the elements after it forward. Keeps the order of the elements.
+	///
+	/// \param index Index of the element to remove.
+	void Remove(u64 index)
+	{
+		IASSERT(index < m_Size, "Out of bounds remove in Array");
+
+		m_Data[index].~T();
+		Private::Relocate(m_Data + index, m_Data + index + 1, m_Size - index - 1);
+		m_Size--;
+	}
+
+	/// Remove an element by moving the last element into its place. Doesn't keep the order of the elements,
+	/// but doesn't have to move every element after it.
+	///
+	/// \param index Index of the element to remove.
+	void RemoveSwap(u64 index)
+	{
+		IASSERT(index < m_Size, "Out of bounds remove in Array");
+
+		m_Data[index].~T();
+		m_Size--;
+		if (index != m_Size)
+		{
+			Private::Relocate(m_Data + index, m_Data + m_Size, 1);
+		}
+	}
+
+	/// Resize the Array, default constructing new elements, or destroying the elements past the new size.
+	///
+	/// \param size The new size.
+	void Resize(u64 size)
+	{
+		Realloc(size);
+		for (u64 i = m_Size; i < size; i++)
+		{
+			Construct<T>(m_Data + i);
+		}
+		for (u64 i = size; i < m_Size; i++)
+		{
+			m_Data[i].~T();
+		}
+		m_Size = size;
+	}
+
+	/// Resize the Array, copying a value into new elements, or destroying the elements past the new size.
+	///
+	/// \param size The new size.
+	/// \param value Value to copy into new elements. Must not be from this Array.
+	void Resize(u64 size, const T& value)
+	{
+		Realloc(size);
+		for (u64 i = m_Size; i < size; i++)
+		{
+			Construct<T>(m_Data + i, value);
+		}
+		for (u64 i = size; i < m_Size; i++)
+		{
+			m_Data[i].~T();
+		}
+		m_Size = size;
+	}
+
+	/// Resize the Array, leaving new elements uninitialized, for when they are about to be written to with Data().
+	///
+	/// \param size The new size.
+	void ResizeUninitialized(u64 size)
+		requires std::is_trivial_v<T>
+	{
+		Realloc(size);
+		m_Size = size;
+	}
+
+	/// Shrink the allocation to fit the elements. Frees it if the Array is empty.
+	void ShrinkToFit()
+	{
+		if (m_Capacity == m_Size)
+		{
+			return;
+		}
+
+		T* data = nullptr;
+		if (m_Size)
+		{
+			data = reinterpret_cast<T*>(m_Alloc->Allocate(m_Size * sizeof(T), alignof(T)));
+			Private::Relocate(data, m_Data, m_Size);
+		}
+		m_Alloc->Deallocate(m_Data);
+		m_Data = data;
+		m_Capacity = m_Size;
+	}
+
+	/// Clear the Array, destroying all elements. Keeps the allocation around.
 	void Clear()
 	{
 		for (auto& elem : *this)
@@ -371,32 +549,29 @@ private:
 	/// \param size Number of elements required.
 	void Realloc(u64 size)
 	{
-		if (size > m_Capacity)
+		if (size <= m_Capacity)
 		{
-			u64 capacity = m_Capacity;
-			while (capacity < size)
-			{
-				capacity *= 2;
-			}
+			return;
+		}
 
-			u64 trySize = m_Alloc->GrowAllocation(m_Data, m_Capacity * sizeof(T), capacity * sizeof(T)) / sizeof(T);
-			if (trySize < size)
-			{
-				auto data = reinterpret_cast<T*>(m_Alloc->Allocate(capacity * sizeof(T)));
-				MemCopy(data, m_Data, m_Size * sizeof(T));
-				for (u64 i = 0; auto& elem : *this)
-				{
-					Construct<T>(data + i, std::move(elem));
-				}
-				m_Alloc->Deallocate(m_Data);
-				m_Data = data;
-				m_Capacity = capacity;
-			}
-			else
-			{
-				m_Capacity = trySize;
-			}
+		u64 capacity = m_Capacity ? m_Capacity * 2 : 2;
+		while (capacity < size)
+		{
+			capacity *= 2;
+		}
+
+		u64 trySize = m_Alloc->GrowAllocation(m_Data, m_Capacity * sizeof(T), capacity * sizeof(T)) / sizeof(T);
+		if (trySize >= size)
+		{
+			m_Capacity = trySize;
+			return;
 		}
+
+		auto data = reinterpret_cast<T*>(m_Alloc->Allocate(capacity * sizeof(T), alignof(T)));
+		Private::Relocate(data, m_Data, m_Size);
+		m_Alloc->Deallocate(m_Data);
+		m_Data = data;
+		m_Capacity = capacity;
 	}
 
 	Allocator* m_Alloc = nullptr;
@@ -405,6 +580,15 @@ private:
 	u64 m_Capacity = 0;
 };
 
+namespace Traits {
+
+template<typename T>
+struct IsTriviallyRelocatable<Array<T>> : std::true_type
+{
+};
+
+}
+
 /// Array on the stack, prefer over Array if size is known at compile-time.
 ///
 /// \tparam T Type to hold in the array.
@@ -470,14 +654,501 @@ private:
 	T m_Array[S];
 };
 
-/// Array on the stack, up to S elements,
-/// but switches over to dynamic allocation if the elements exceed S.
+/// Array with inline storage for S elements, which only allocates once it grows past S.
+/// Has the same interface as Array, so use it for lists that are usually short.
 ///
 /// \tparam T Type to hold in the array.
-/// \tparam S Number of elements to hold on the stack.
+/// \tparam S Number of elements to hold inline.
 template<typename T, u64 S = 16>
 class SmallArray
 {
+	static_assert(S > 0, "SmallArray must hold at least one element inline");
+
+public:
+	/// Construct a SmallArray with an allocator. Does not allocate.
+	///
+	/// \param alloc Allocator to use once the elements no longer fit inline. Defaults to the allocator of
+	/// MemoryTag::Containers.
+	SmallArray(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Alloc(&alloc)
+	{
+		SetInline();
+	}
+
+	/// Create a SmallArray from an ArrayRef.
+	///
+	/// \param ref ArrayRef to copy the elements of.
+	/// \param alloc Allocator to use once the elements no longer fit inline. Defaults to the allocator of
+	/// MemoryTag::Containers.
+	SmallArray(ArrayRef<T> ref, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Alloc(&alloc)
+	{
+		SetInline();
+		Realloc(ref.Size());
+		for (auto& elem : ref)
+		{
+			Construct<T>(m_Data + m_Size++, elem);
+		}
+	}
+
+	SmallArray(const std::initializer_list<T>& list,
+		Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Alloc(&alloc)
+	{
+		SetInline();
+		Realloc(list.size());
+		for (const auto& elem : list)
+		{
+			Construct<T>(m_Data + m_Size++, elem);
+		}
+	}
+
+	/// Copy constructor.
+	///
+	/// \param other SmallArray to copy.
+	SmallArray(const SmallArray& other) : m_Alloc(other.GetAlloc())
+	{
+		SetInline();
+		Realloc(other.m_Size);
+		for (auto& elem : other)
+		{
+			Construct<T>(m_Data + m_Size++, elem);
+		}
+	}
+
+	/// Move constructor. Inline elements are moved one by one, heap storage is taken over.
+	///
+	/// \param other SmallArray to move.
+	SmallArray(SmallArray&& other) : m_Alloc(other.GetAlloc())
+	{
+		SetInline();
+		Take(other);
+	}
+
+	/// Destructor.
+	~SmallArray() { Free(); }
+
+	/// Copy assignment.
+	///
+	/// \param other SmallArray to copy.
+	SmallArray& operator=(const SmallArray& other)
+	{
+		if (this == &other)
+		{
+			return *this;
+		}
+
+		Clear();
+		Realloc(other.m_Size);
+		for (auto& elem : other)
+		{
+			Construct<T>(m_Data + m_Size++, elem);
+		}
+
+		return *this;
+	}
+
+	/// Move assignment.
+	///
+	/// \param other SmallArray to move.
+	SmallArray& operator=(SmallArray&& other)
+	{
+		if (this == &other)
+		{
+			return *this;
+		}
+
+		Free();
+		m_Alloc = other.GetAlloc();
+		SetInline();
+		Take(other);
+
+		return *this;
+	}
+
+	/// Index.
+	///
+	/// \param index The index of the element to access.
+	///
+	/// \return The element.
+	T& operator[](u64 index)
+	{
+		IASSERT(index < m_Size, "Out of bounds access in SmallArray");
+		return m_Data[index];
+	}
+
+	/// Index.
+	///
+	/// \param index The index of the element to access.
+	///
+	/// \return The element.
+	const T& operator[](u64 index) const
+	{
+		IASSERT(index < m_Size, "Out of bounds access in SmallArray");
+		return m_Data[index];
+	}
+
+	/// Convert the SmallArray into an ArrayRef.
+	operator ArrayRef<T>() { return ArrayRef<T>(Data(), Size()); }
+
+	/// Get the first element of the SmallArray.
+	///
+	/// \return Pointer to the first element of the SmallArray.
+	const T* Data() const { return m_Data; }
+
+	/// Get the first element of the SmallArray.
+	///
+	/// \return Pointer to the first element of the SmallArray.
+	T* Data() { return m_Data; }
+
+	/// Get the number of elements in the SmallArray.
+	///
+	/// \return The number of elements.
+	u64 Size() const { return m_Size; }
+
+	/// Get the number of elements the SmallArray can hold without reallocating.
+	///
+	/// \return The capacity. Is S while the elements are inline.
+	u64 Capacity() const { return m_Capacity; }
+
+	/// Check if the elements are stored inline.
+	///
+	/// \return If the elements are inline.
+	bool IsInline() const { return u64(m_Alloc) & 1; }
+
+	/// Reserve space in the SmallArray. Allocates if size is more than S.
+	///
+	/// \param size The number of elements to reserve space for.
+	void Reserve(u64 size) { Realloc(size); }
+
+	/// Push a copy of an object into the end of the SmallArray.
+	///
+	/// \param object Object to push.
+	///
+	/// \return Reference to the object in the SmallArray.
+	T& Push(const T& object)
+	{
+		Realloc(m_Size + 1);
+		auto ptr = Construct<T>(m_Data + m_Size, object);
+		m_Size++;
+		return *ptr;
+	}
+
+	/// Push an object into the end of the SmallArray.
+	///
+	/// \param object Object to push.
+	///
+	/// \return Reference to the object in the SmallArray.
+	T& Push(T&& object)
+	{
+		Realloc(m_Size + 1);
+		auto ptr = Construct<T>(m_Data + m_Size, std::move(object));
+		m_Size++;
+		return *ptr;
+	}
+
+	/// Construct an object in place at the end of the SmallArray.
+	///
+	/// \param args Arguments to pass to the constructor.
+	///
+	/// \return Constructed object.
+	template<typename... Args>
+	T& Emplace(Args&&... args)
+	{
+		Realloc(m_Size + 1);
+		auto ptr = Construct<T>(m_Data + m_Size, static_cast<Args&&>(args)...);
+		m_Size++;
+		return *ptr;
+	}
+
+	/// Copy elements to the end of the SmallArray, reallocating at most once.
+	///
+	/// \param elements Elements to copy. Must not be from this SmallArray.
+	void Append(ArrayRef<T> elements) { InsertRange(m_Size, elements); }
+
+	/// Copy elements into the SmallArray, moving the elements after them back.
+	///
+	/// \param index Index to insert the first element at. Can be Size() to append.
+	/// \param elements Elements to copy. Must not be from this SmallArray.
+	void InsertRange(u64 index, ArrayRef<T> elements)
+	{
+		IASSERT(index <= m_Size, "Out of bounds insert in SmallArray");
+		IASSERT(elements.Data() + elements.Size() <= m_Data || elements.Data() >= m_Data + m_Size,
+			"Cannot insert elements of a SmallArray into itself");
+
+		u64 count = elements.Size();
+		if (!count)
+		{
+			return;
+		}
+
+		Realloc(m_Size + count);
+		Private::Relocate(m_Data + index + count, m_Data + index, m_Size - index);
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			MemCopy(m_Data + index, elements.Data(), count * sizeof(T));
+		}
+		else
+		{
+			for (u64 i = 0; i < count; i++)
+			{
+				Construct<T>(m_Data + index + i, elements[i]);
+			}
+		}
+		m_Size += count;
+	}
+
+	/// Insert a copy of an object, moving the elements after it back.
+	///
+	/// \param index Index to insert the object at. Can be Size() to push.
+	/// \param object Object to insert. Must not be from this SmallArray.
+	///
+	/// \return Reference to the object in the SmallArray.
+	T& Insert(u64 index, const T& object)
+	{
+		IASSERT(index <= m_Size, "Out of bounds insert in SmallArray");
+
+		Realloc(m_Size + 1);
+		Private::Relocate(m_Data + index + 1, m_Data + index, m_Size - index);
+		auto ptr = Construct<T>(m_Data + index, object);
+		m_Size++;
+		return *ptr;
+	}
+
+	/// Insert an object, moving the elements after it back.
+	///
+	/// \param index Index to insert the object at. Can be Size() to push.
+	/// \param object Object to insert. Must not be from this SmallArray.
+	///
+	/// \return Reference to the object in the SmallArray.
+	T& Insert(u64 index, T&& object)
+	{
+		IASSERT(index <= m_Size, "Out of bounds insert in SmallArray");
+
+		Realloc(m_Size + 1);
+		Private::Relocate(m_Data + index + 1, m_Data + index, m_Size - index);
+		auto ptr = Construct<T>(m_Data + index, std::move(object));
+		m_Size++;
+		return *ptr;
+	}
+
+	/// Remove an element, moving the elements after it forward. Keeps the order of the elements.
+	///
+	/// \param index Index of the element to remove.
+	void Remove(u64 index)
+	{
+		IASSERT(index < m_Size, "Out of bounds remove in SmallArray");
+
+		m_Data[index].~T();
+		Private::Relocate(m_Data + index, m_Data + index + 1, m_Size - index - 1);
+		m_Size--;
+	}
+
+	/// Remove an element by moving the last element into its place. Doesn't keep the order of the elements,
+	/// but doesn't have to move every element after it.
+	///
+	/// \param index Index of the element to remove.
+	void RemoveSwap(u64 index)
+	{
+		IASSERT(index < m_Size, "Out of bounds remove in SmallArray");
+
+		m_Data[index].~T();
+		m_Size--;
+		if (index != m_Size)
+		{
+			Private::Relocate(m_Data + index, m_Data + m_Size, 1);
+		}
+	}
+
+	/// Resize the SmallArray, default constructing new elements, or destroying the elements past the new size.
+	///
+	/// \param size The new size.
+	void Resize(u64 size)
+	{
+		Realloc(size);
+		for (u64 i = m_Size; i < size; i++)
+		{
+			Construct<T>(m_Data + i);
+		}
+		for (u64 i = size; i < m_Size; i++)
+		{
+			m_Data[i].~T();
+		}
+		m_Size = size;
+	}
+
+	/// Resize the SmallArray, copying a value into new elements, or destroying the elements past the new size.
+	///
+	/// \param size The new size.
+	/// \param value Value to copy into new elements. Must not be from this SmallArray.
+	void Resize(u64 size, const T& value)
+	{
+		Realloc(size);
+		for (u64 i = m_Size; i < size; i++)
+		{
+			Construct<T>(m_Data + i, value);
+		}
+		for (u64 i = size; i < m_Size; i++)
+		{
+			m_Data[i].~T();
+		}
+		m_Size = size;
+	}
+
+	/// Resize the SmallArray, leaving new elements uninitialized, for when they are about to be written to with
+	/// Data().
+	///
+	/// \param size The new size.
+	void ResizeUninitialized(u64 size)
+		requires std::is_trivial_v<T>
+	{
+		Realloc(size);
+		m_Size = size;
+	}
+
+	/// Shrink the heap storage to fit the elements. Moves them back inline if they fit in S.
+	void ShrinkToFit()
+	{
+		if (IsInline() || m_Capacity == m_Size)
+		{
+			return;
+		}
+
+		Allocator* alloc = GetAlloc();
+		T* heap = m_Data;
+		if (m_Size <= S)
+		{
+			SetInline();
+			Private::Relocate(m_Data, heap, m_Size);
+		}
+		else
+		{
+			m_Data = reinterpret_cast<T*>(alloc->Allocate(m_Size * sizeof(T), alignof(T)));
+			Private::Relocate(m_Data, heap, m_Size);
+			m_Capacity = m_Size;
+		}
+		alloc->Deallocate(heap);
+	}
+
+	/// Clear the SmallArray, destroying all elements. Keeps any heap storage around.
+	void Clear()
+	{
+		for (auto& elem : *this)
+		{
+			elem.~T();
+		}
+
+		m_Size = 0;
+	}
+
+	/// Iteration.
+	///
+	/// \return Pointer to the first element of the SmallArray.
+	T* begin() { return m_Data; }
+
+	/// Iteration.
+	///
+	/// \return Pointer to the first element of the SmallArray.
+	const T* begin() const { return m_Data; }
+
+	/// Iteration.
+	///
+	/// \return Pointer to the element after the last element in the SmallArray.
+	T* end() { return m_Data + m_Size; }
+
+	/// Iteration.
+	///
+	/// \return Pointer to the element after the last element in the SmallArray.
+	const T* end() const { return m_Data + m_Size; }
+
+private:
+	Allocator* GetAlloc() const { return reinterpret_cast<Allocator*>(u64(m_Alloc) & ~u64(1)); }
+
+	/// Point at the inline storage, without touching any elements.
+	void SetInline()
+	{
+		m_Alloc = reinterpret_cast<Allocator*>(u64(m_Alloc) | 1);
+		m_Data = reinterpret_cast<T*>(m_Inline);
+		m_Capacity = S;
+	}
+
+	/// Destroy all elements and free heap storage.
+	void Free()
+	{
+		Clear();
+		if (!IsInline())
+		{
+			GetAlloc()->Deallocate(m_Data);
+		}
+	}
+
+	/// Take the elements of other. This must be empty and inline, and other is left empty and inline.
+	void Take(SmallArray& other)
+	{
+		if (other.IsInline())
+		{
+			for (auto& elem : other)
+			{
+				Construct<T>(m_Data + m_Size++, std::move(elem));
+			}
+			other.Clear();
+		}
+		else
+		{
+			m_Alloc = other.GetAlloc();
+			m_Data = other.m_Data;
+			m_Size = other.m_Size;
+			m_Capacity = other.m_Capacity;
+
+			other.m_Size = 0;
+			other.SetInline();
+		}
+	}
+
+	/// Move to the heap if the capacity is not enough.
+	///
+	/// \param size Number of elements required.
+	void Realloc(u64 size)
+	{
+		if (size <= m_Capacity)
+		{
+			return;
+		}
+
+		u64 capacity = m_Capacity * 2;
+		while (capacity < size)
+		{
+			capacity *= 2;
+		}
+
+		if (!IsInline())
+		{
+			u64 trySize = GetAlloc()->GrowAllocation(m_Data, m_Capacity * sizeof(T), capacity * sizeof(T)) / sizeof(T);
+			if (trySize >= size)
+			{
+				m_Capacity = trySize;
+				return;
+			}
+		}
+
+		auto data = reinterpret_cast<T*>(GetAlloc()->Allocate(capacity * sizeof(T), alignof(T)));
+		Private::Relocate(data, m_Data, m_Size);
+
+		if (!IsInline())
+		{
+			GetAlloc()->Deallocate(m_Data);
+		}
+		m_Alloc = GetAlloc();
+		m_Data = data;
+		m_Capacity = capacity;
+	}
+
+	/// Allocator to spill to, with the lowest bit set while the elements are inline.
+	Allocator* m_Alloc;
+	T* m_Data;
+	u64 m_Size = 0;
+	u64 m_Capacity;
+	alignas(T) u8 m_Inline[S * sizeof(T)];
 };
 
 }
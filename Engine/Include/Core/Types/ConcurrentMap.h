@@ -0,0 +1,389 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Key-value pair maps that can be shared between threads.
+
+#pragma once
+#include <atomic>
+
+#include "Core/Memory/Epoch.h"
+#include "Core/Types/Map.h"
+
+namespace Ignis {
+
+/// HashMap that many threads can read and write at once, for caches and registries shared by every job.
+/// Reads take no locks: they only count themselves in an EpochDomain and follow pointers.
+/// Writes lock one of 64 shards, picked by the top bits of the hash, so writers to different shards don't contend.
+///
+/// Entries are never changed in place. Overwriting or removing an entry swaps it out of its bucket,
+/// and growing a shard copies its entries into a new table, so K and V must be copyable.
+/// The old entries and tables are freed once no reader can be looking at them.
+/// Readers can only see values inside Get() and Visit(), and never get pointers into the map.
+///
+/// \tparam K Key type.
+/// \tparam V Value type.
+template<HashKey K, typename V>
+class ConcurrentHashMap
+{
+public:
+	/// Construct a ConcurrentHashMap. Does not allocate until the first entry is inserted.
+	///
+	/// \param alloc Allocator to use, must be thread safe. Defaults to the allocator of MemoryTag::Containers.
+	ConcurrentHashMap(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Alloc(&alloc), m_Epoch(alloc) {}
+
+	ConcurrentHashMap(const ConcurrentHashMap& other) = delete;
+
+	/// Destructor. No other threads may be using the map.
+	~ConcurrentHashMap()
+	{
+		for (auto& shard : m_Shards)
+		{
+			FreeTable(shard.Buckets.load(std::memory_order::relaxed), this);
+		}
+	}
+
+	/// Copy out the value stored at a key.
+	///
+	/// \param key Key to search for.
+	/// \param value Where to copy the value to.
+	///
+	/// \return If the key exists. value is left untouched if it doesn't.
+	template<HashLookup<K> Q>
+	bool Get(const Q& key, V& value) const
+	{
+		return Visit(key, [&value](const V& stored) { value = stored; });
+	}
+
+	/// Call a function with the value stored at a key, without copying it.
+	/// The function must not block or touch the map, and the reference must not escape it.
+	///
+	/// \param key Key to search for.
+	/// \param function Function to call with a const reference to the value.
+	///
+	/// \return If the key exists, and the function was called.
+	template<HashLookup<K> Q, typename F>
+	bool Visit(const Q& key, F&& function) const
+	{
+		EpochDomain::Guard guard(m_Epoch);
+		const Node* node = Find(key, Hasher<K>::Hash(key));
+		if (node)
+		{
+			function(node->Entry.Second);
+		}
+
+		return node != nullptr;
+	}
+
+	/// Check if a key exists.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return If the key exists.
+	template<HashLookup<K> Q>
+	bool Contains(const Q& key) const
+	{
+		EpochDomain::Guard guard(m_Epoch);
+		return Find(key, Hasher<K>::Hash(key)) != nullptr;
+	}
+
+	/// Insert a key-value pair. If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	///
+	/// \return If the key did not exist before.
+	bool Insert(const K& key, const V& value) { return Insert(key, value, true); }
+
+	/// Insert a key-value pair, only if the key doesn't exist yet.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	///
+	/// \return If the pair was inserted.
+	bool TryInsert(const K& key, const V& value) { return Insert(key, value, false); }
+
+	/// Remove an entry.
+	///
+	/// \param key Entry to remove.
+	///
+	/// \return If the entry existed.
+	template<HashLookup<K> Q>
+	bool Remove(const Q& key)
+	{
+		u64 hash = Hasher<K>::Hash(key);
+		Shard& shard = GetShard(hash);
+		Lock(shard);
+
+		Table* table = shard.Buckets.load(std::memory_order::relaxed);
+		std::atomic<Node*>* link = table ? FindLink(table, key, hash) : nullptr;
+		Node* node = link ? link->load(std::memory_order::relaxed) : nullptr;
+		if (node)
+		{
+			link->store(node->Next.load(std::memory_order::relaxed), std::memory_order::release);
+			shard.Size.fetch_sub(1, std::memory_order::relaxed);
+		}
+
+		Unlock(shard);
+
+		if (node)
+		{
+			m_Epoch.Retire(node, &FreeNode, this);
+		}
+
+		return node != nullptr;
+	}
+
+	/// Call a function with every key-value pair.
+	/// Entries inserted or removed during iteration may or may not be visited.
+	/// The function must not block or touch the map, and the references must not escape it.
+	///
+	/// \param function Function to call with const references to the key and the value.
+	template<typename F>
+	void ForEach(F&& function) const
+	{
+		EpochDomain::Guard guard(m_Epoch);
+		for (auto& shard : m_Shards)
+		{
+			const Table* table = shard.Buckets.load(std::memory_order::acquire);
+			if (!table)
+			{
+				continue;
+			}
+
+			for (u64 i = 0; i <= table->Mask; i++)
+			{
+				for (const Node* node = table->Buckets()[i].load(std::memory_order::acquire); node;
+					 node = node->Next.load(std::memory_order::acquire))
+				{
+					function(node->Entry.First, node->Entry.Second);
+				}
+			}
+		}
+	}
+
+	/// Get the number of entries. Only a snapshot if other threads are writing.
+	///
+	/// \return The number of entries.
+	u64 Size() const
+	{
+		u64 size = 0;
+		for (auto& shard : m_Shards)
+		{
+			size += shard.Size.load(std::memory_order::relaxed);
+		}
+
+		return size;
+	}
+
+	/// Free entries that were overwritten or removed, and that no reader can be looking at anymore.
+	/// Happens on its own as the map is written to, so this is only needed after the last writes.
+	void Reclaim() { m_Epoch.Reclaim(); }
+
+private:
+	struct Node
+	{
+		Node(Node* next, u64 hash, const K& key, const V& value) : Next(next), Hash(hash), Entry { key, value } {}
+
+		std::atomic<Node*> Next;
+		u64 Hash;
+		Pair<K, V> Entry;
+	};
+
+	/// Bucket heads follow the header in the same allocation.
+	struct Table
+	{
+		u64 Mask;
+
+		std::atomic<Node*>* Buckets() { return reinterpret_cast<std::atomic<Node*>*>(this + 1); }
+
+		const std::atomic<Node*>* Buckets() const { return reinterpret_cast<const std::atomic<Node*>*>(this + 1); }
+	};
+
+	struct alignas(64) Shard
+	{
+		std::atomic_flag Lock;
+		std::atomic<Table*> Buckets = nullptr;
+		std::atomic<u64> Size = 0;
+	};
+
+	static constexpr u64 ShardBits = 6;
+	static constexpr u64 InitialBuckets = 16;
+
+	/// The top bits pick the shard, and the low bits pick the bucket, so they stay independent.
+	Shard& GetShard(u64 hash) { return m_Shards[hash >> (64 - ShardBits)]; }
+
+	const Shard& GetShard(u64 hash) const { return m_Shards[hash >> (64 - ShardBits)]; }
+
+	static void Lock(Shard& shard)
+	{
+		while (shard.Lock.test_and_set(std::memory_order::acquire)) {}
+	}
+
+	static void Unlock(Shard& shard) { shard.Lock.clear(std::memory_order::release); }
+
+	/// Find a node. Must be called with a Guard alive.
+	template<typename Q>
+	const Node* Find(const Q& key, u64 hash) const
+	{
+		const Table* table = GetShard(hash).Buckets.load(std::memory_order::acquire);
+		if (!table)
+		{
+			return nullptr;
+		}
+
+		for (const Node* node = table->Buckets()[hash & table->Mask].load(std::memory_order::acquire); node;
+			 node = node->Next.load(std::memory_order::acquire))
+		{
+			if (node->Hash == hash && node->Entry.First == key)
+			{
+				return node;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/// Find the link pointing to a node, so it can be swapped out. Must be called with the shard locked.
+	///
+	/// \return The link, or nullptr if the key doesn't exist.
+	template<typename Q>
+	static std::atomic<Node*>* FindLink(Table* table, const Q& key, u64 hash)
+	{
+		std::atomic<Node*>* link = &table->Buckets()[hash & table->Mask];
+		for (Node* node = link->load(std::memory_order::relaxed); node; node = link->load(std::memory_order::relaxed))
+		{
+			if (node->Hash == hash && node->Entry.First == key)
+			{
+				return link;
+			}
+			link = &node->Next;
+		}
+
+		return nullptr;
+	}
+
+	bool Insert(const K& key, const V& value, bool overwrite)
+	{
+		u64 hash = Hasher<K>::Hash(key);
+		Shard& shard = GetShard(hash);
+		Lock(shard);
+
+		Table* table = shard.Buckets.load(std::memory_order::relaxed);
+		if (!table)
+		{
+			table = AllocateTable(InitialBuckets);
+			shard.Buckets.store(table, std::memory_order::release);
+		}
+
+		std::atomic<Node*>* link = FindLink(table, key, hash);
+		if (link)
+		{
+			Node* old = nullptr;
+			if (overwrite)
+			{
+				old = link->load(std::memory_order::relaxed);
+				Node* node = Create<Node>(*m_Alloc, old->Next.load(std::memory_order::relaxed), hash, key, value);
+				link->store(node, std::memory_order::release);
+			}
+
+			Unlock(shard);
+
+			if (old)
+			{
+				m_Epoch.Retire(old, &FreeNode, this);
+			}
+
+			return false;
+		}
+
+		std::atomic<Node*>& bucket = table->Buckets()[hash & table->Mask];
+		bucket.store(Create<Node>(*m_Alloc, bucket.load(std::memory_order::relaxed), hash, key, value),
+			std::memory_order::release);
+
+		Table* old = nullptr;
+		if (shard.Size.fetch_add(1, std::memory_order::relaxed) + 1 > table->Mask + 1)
+		{
+			old = table;
+			shard.Buckets.store(Grow(table), std::memory_order::release);
+		}
+
+		Unlock(shard);
+
+		if (old)
+		{
+			m_Epoch.Retire(old, &FreeTable, this);
+		}
+
+		return true;
+	}
+
+	/// Copy every node into a table twice the size. Readers may still be walking the old nodes, so they can't be
+	/// relinked.
+	Table* Grow(const Table* table)
+	{
+		Table* grown = AllocateTable((table->Mask + 1) * 2);
+		for (u64 i = 0; i <= table->Mask; i++)
+		{
+			for (const Node* node = table->Buckets()[i].load(std::memory_order::relaxed); node;
+				 node = node->Next.load(std::memory_order::relaxed))
+			{
+				std::atomic<Node*>& bucket = grown->Buckets()[node->Hash & grown->Mask];
+				bucket.store(Create<Node>(*m_Alloc, bucket.load(std::memory_order::relaxed), node->Hash,
+								 node->Entry.First, node->Entry.Second),
+					std::memory_order::relaxed);
+			}
+		}
+
+		return grown;
+	}
+
+	Table* AllocateTable(u64 bucketCount)
+	{
+		auto table = reinterpret_cast<Table*>(
+			m_Alloc->Allocate(sizeof(Table) + bucketCount * sizeof(std::atomic<Node*>), alignof(Table)));
+		table->Mask = bucketCount - 1;
+		for (u64 i = 0; i < bucketCount; i++)
+		{
+			Construct<std::atomic<Node*>>(&table->Buckets()[i], nullptr);
+		}
+
+		return table;
+	}
+
+	static void FreeNode(void* node, void* map)
+	{
+		Destroy(*reinterpret_cast<ConcurrentHashMap*>(map)->m_Alloc, reinterpret_cast<Node*>(node));
+	}
+
+	/// Free a table along with the nodes still linked into it.
+	static void FreeTable(void* ptr, void* map)
+	{
+		auto table = reinterpret_cast<Table*>(ptr);
+		if (!table)
+		{
+			return;
+		}
+
+		Allocator& alloc = *reinterpret_cast<ConcurrentHashMap*>(map)->m_Alloc;
+		for (u64 i = 0; i <= table->Mask; i++)
+		{
+			Node* node = table->Buckets()[i].load(std::memory_order::relaxed);
+			while (node)
+			{
+				Node* next = node->Next.load(std::memory_order::relaxed);
+				Destroy(alloc, node);
+				node = next;
+			}
+		}
+
+		alloc.Deallocate(table, sizeof(Table) + (table->Mask + 1) * sizeof(std::atomic<Node*>));
+	}
+
+	Allocator* m_Alloc;
+	Shard m_Shards[u64(1) << ShardBits];
+
+	/// Declared last, so retired memory is freed before anything else is torn down.
+	EpochDomain m_Epoch;
+};
+
+}
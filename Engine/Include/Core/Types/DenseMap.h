@@ -0,0 +1,499 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Key-value pair maps with contiguous storage.
+
+#pragma once
+#include "Core/Types/Array.h"
+#include "Core/Types/Map.h"
+
+namespace Ignis {
+
+/// HashMap that keeps its entries packed in an Array, for maps that are iterated more than they are searched.
+/// Iteration is a linear scan over the entries, without skipping over empty slots.
+/// Lookups go through a separate Swiss table of indices into the entries, probed like a HashMap.
+///
+/// Removal moves the last entry into the hole, so removing reorders the entries, and invalidates pointers to the last
+/// one. Inserting invalidates all pointers to entries, like pushing to an Array does.
+///
+/// \tparam K Key type.
+/// \tparam V Value type.
+template<HashKey K, typename V>
+class DenseHashMap
+{
+public:
+	using Iterator = Pair<K, V>*;
+	using ConstIterator = const Pair<K, V>*;
+
+	/// Constructor. Does not allocate until the first entry is inserted.
+	///
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	DenseHashMap(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Alloc(&alloc), m_Entries(alloc) {}
+
+	/// Copy constructor.
+	///
+	/// \param other DenseHashMap to copy.
+	DenseHashMap(const DenseHashMap& other) : m_Alloc(other.m_Alloc), m_Entries(other.m_Entries)
+	{
+		CopyIndex(other);
+	}
+
+	/// Move constructor.
+	///
+	/// \param other DenseHashMap to move.
+	DenseHashMap(DenseHashMap&& other)
+		: m_Alloc(other.m_Alloc), m_Entries(static_cast<Array<Pair<K, V>>&&>(other.m_Entries))
+	{
+		TakeIndex(other);
+	}
+
+	/// Destructor.
+	~DenseHashMap() { FreeIndex(); }
+
+	/// Copy assignment.
+	///
+	/// \param other DenseHashMap to copy.
+	DenseHashMap& operator=(const DenseHashMap& other)
+	{
+		if (this != &other)
+		{
+			FreeIndex();
+			m_Alloc = other.m_Alloc;
+			m_Entries = other.m_Entries;
+			CopyIndex(other);
+		}
+
+		return *this;
+	}
+
+	/// Move assignment.
+	///
+	/// \param other DenseHashMap to move.
+	DenseHashMap& operator=(DenseHashMap&& other)
+	{
+		if (this != &other)
+		{
+			FreeIndex();
+			m_Alloc = other.m_Alloc;
+			m_Entries = static_cast<Array<Pair<K, V>>&&>(other.m_Entries);
+			TakeIndex(other);
+		}
+
+		return *this;
+	}
+
+	/// Get the value stored at a key, default constructing it if the key doesn't exist.
+	///
+	/// \param key The key.
+	///
+	/// \return Reference to the value.
+	V& operator[](const K& key)
+	{
+		u64 hash = Hasher<K>::Hash(key);
+		u64 slot = Find(key, hash);
+		if (slot != NotFound)
+		{
+			return m_Entries[m_Indices[slot]].Second;
+		}
+
+		PrepareInsert(hash);
+		return m_Entries.Push({ key, V() }).Second;
+	}
+
+	/// Insert a key-value pair into the DenseHashMap.
+	/// If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	///
+	/// \return Reference to the key-value pair stored.
+	Pair<K, V>& Insert(const K& key, const V& value)
+	{
+		u64 hash = Hasher<K>::Hash(key);
+		u64 slot = Find(key, hash);
+		if (slot != NotFound)
+		{
+			Pair<K, V>& entry = m_Entries[m_Indices[slot]];
+			entry.Second = value;
+			return entry;
+		}
+
+		PrepareInsert(hash);
+		return m_Entries.Push({ key, value });
+	}
+
+	/// Insert a key-value pair into the DenseHashMap.
+	/// If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	///
+	/// \return Reference to the key-value pair stored.
+	Pair<K, V>& Insert(K&& key, V&& value)
+	{
+		u64 hash = Hasher<K>::Hash(key);
+		u64 slot = Find(key, hash);
+		if (slot != NotFound)
+		{
+			Pair<K, V>& entry = m_Entries[m_Indices[slot]];
+			entry.Second = static_cast<V&&>(value);
+			return entry;
+		}
+
+		PrepareInsert(hash);
+		return m_Entries.Push({ static_cast<K&&>(key), static_cast<V&&>(value) });
+	}
+
+	/// Get the value stored at a key.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	V* Get(const K& key) { return Get<K>(key); }
+
+	/// Get the value stored at a key.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	const V* Get(const K& key) const { return Get<K>(key); }
+
+	/// Get the value stored at a key, without converting the key to K.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	template<HashLookup<K> Q>
+	V* Get(const Q& key)
+	{
+		u64 slot = Find(key, Hasher<K>::Hash(key));
+		return slot == NotFound ? nullptr : &m_Entries[m_Indices[slot]].Second;
+	}
+
+	/// Get the value stored at a key, without converting the key to K.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	template<HashLookup<K> Q>
+	const V* Get(const Q& key) const
+	{
+		u64 slot = Find(key, Hasher<K>::Hash(key));
+		return slot == NotFound ? nullptr : &m_Entries[m_Indices[slot]].Second;
+	}
+
+	/// Remove an entry from the DenseHashMap. Moves the last entry into its place.
+	///
+	/// \param key Entry to remove.
+	void Remove(const K& key) { Remove<K>(key); }
+
+	/// Remove an entry from the DenseHashMap, without converting the key to K. Moves the last entry into its place.
+	///
+	/// \param key Entry to remove.
+	template<HashLookup<K> Q>
+	void Remove(const Q& key)
+	{
+		u64 slot = Find(key, Hasher<K>::Hash(key));
+		if (slot == NotFound)
+		{
+			return;
+		}
+
+		u32 index = m_Indices[slot];
+		EraseSlot(slot);
+
+		// Point the slot of the last entry to where it is moving.
+		u64 last = m_Entries.Size() - 1;
+		if (index != last)
+		{
+			m_Indices[FindIndex(Hasher<K>::Hash(m_Entries[last].First), last)] = index;
+		}
+		m_Entries.RemoveSwap(index);
+	}
+
+	/// Remove every entry. Keeps the allocations around.
+	void Clear()
+	{
+		m_Entries.Clear();
+		if (m_Capacity)
+		{
+			MemSet(m_Ctrl, Private::CtrlEmpty, m_Capacity);
+			m_GrowthLeft = MaxLoad(m_Capacity);
+		}
+	}
+
+	/// Make sure entries can be inserted without reallocating.
+	///
+	/// \param count Number of entries to make space for, including the ones already in the DenseHashMap.
+	void Reserve(u64 count)
+	{
+		m_Entries.Reserve(count);
+		u64 capacity = CapacityFor(count);
+		if (capacity > m_Capacity)
+		{
+			Rebuild(capacity);
+		}
+	}
+
+	/// Get the number of entries in the DenseHashMap.
+	///
+	/// \return The number of entries.
+	u64 Size() const { return m_Entries.Size(); }
+
+	/// Get the capacity of the DenseHashMap before the index must be rebuilt.
+	///
+	/// \return The number of entries that can be stored until the index must be rebuilt.
+	u64 Capacity() const { return MaxLoad(m_Capacity); }
+
+	/// Get the entries, in no particular order.
+	///
+	/// \return The entries.
+	ArrayRef<Pair<K, V>> Entries() { return m_Entries; }
+
+	/// Iteration.
+	///
+	/// \return Begin Iterator.
+	Iterator begin() { return m_Entries.begin(); }
+
+	/// Iteration.
+	///
+	/// \return Begin Iterator.
+	ConstIterator begin() const { return m_Entries.begin(); }
+
+	/// Iteration.
+	///
+	/// \return End Iterator.
+	Iterator end() { return m_Entries.end(); }
+
+	/// Iteration.
+	///
+	/// \return End Iterator.
+	ConstIterator end() const { return m_Entries.end(); }
+
+private:
+	static constexpr u64 NotFound = u64(-1);
+	static constexpr u64 Width = Private::ControlGroup::Width;
+
+	/// Most entries an index can hold, at 7/8 load.
+	static u64 MaxLoad(u64 capacity) { return capacity - capacity / 8; }
+
+	/// Smallest index capacity that can hold a number of entries.
+	static u64 CapacityFor(u64 count)
+	{
+		u64 capacity = Width;
+		while (MaxLoad(capacity) < count)
+		{
+			capacity *= 2;
+		}
+
+		return capacity;
+	}
+
+	/// Find the slot of a key.
+	///
+	/// \return Index of the slot, or NotFound.
+	template<typename Q>
+	u64 Find(const Q& key, u64 hash) const
+	{
+		u8 tag = u8(hash & 0x7F);
+		u64 groupMask = m_Capacity ? m_Capacity / Width - 1 : 0;
+		u64 group = (hash >> 7) & groupMask;
+
+		for (u64 step = 1; step <= groupMask + 1; step++)
+		{
+			Private::ControlGroup ctrl(m_Ctrl + group * Width);
+			for (u32 mask = ctrl.Match(tag); mask; mask &= mask - 1)
+			{
+				u64 slot = group * Width + Private::CountTrailingZeros(mask);
+				if (m_Entries[m_Indices[slot]].First == key)
+				{
+					return slot;
+				}
+			}
+
+			if (ctrl.MatchEmpty())
+			{
+				return NotFound;
+			}
+
+			group = (group + step) & groupMask;
+		}
+
+		return NotFound;
+	}
+
+	/// Find the slot pointing to an entry, without comparing keys.
+	u64 FindIndex(u64 hash, u64 index) const
+	{
+		u8 tag = u8(hash & 0x7F);
+		u64 groupMask = m_Capacity / Width - 1;
+		u64 group = (hash >> 7) & groupMask;
+
+		for (u64 step = 1;; step++)
+		{
+			for (u32 mask = Private::ControlGroup(m_Ctrl + group * Width).Match(tag); mask; mask &= mask - 1)
+			{
+				u64 slot = group * Width + Private::CountTrailingZeros(mask);
+				if (m_Indices[slot] == index)
+				{
+					return slot;
+				}
+			}
+
+			group = (group + step) & groupMask;
+		}
+	}
+
+	/// Find the first empty or deleted slot in the probe sequence of a hash.
+	u64 FindFree(u64 hash) const
+	{
+		u64 groupMask = m_Capacity / Width - 1;
+		u64 group = (hash >> 7) & groupMask;
+		for (u64 step = 1;; step++)
+		{
+			u32 mask = Private::ControlGroup(m_Ctrl + group * Width).MatchFree();
+			if (mask)
+			{
+				return group * Width + Private::CountTrailingZeros(mask);
+			}
+
+			group = (group + step) & groupMask;
+		}
+	}
+
+	/// Point a free slot to the entry about to be pushed. Rebuilds the index if needed.
+	void PrepareInsert(u64 hash)
+	{
+		IASSERT(m_Entries.Size() < u64(u32(-1)), "DenseHashMap can only hold 2^32 - 1 entries");
+
+		u64 slot = m_Capacity ? FindFree(hash) : 0;
+		if (!m_GrowthLeft && (!m_Capacity || m_Ctrl[slot] != Private::CtrlDeleted))
+		{
+			// Rebuilding at the same size is enough to clear out deleted slots if they are most of the used ones.
+			u64 size = m_Entries.Size();
+			Rebuild(m_Capacity && size * 2 < MaxLoad(m_Capacity) ? m_Capacity : CapacityFor(size + 1));
+			slot = FindFree(hash);
+		}
+
+		if (m_Ctrl[slot] == Private::CtrlEmpty)
+		{
+			m_GrowthLeft--;
+		}
+		m_Ctrl[slot] = u8(hash & 0x7F);
+		m_Indices[slot] = u32(m_Entries.Size());
+	}
+
+	/// Free a slot, the same way HashMap does.
+	void EraseSlot(u64 slot)
+	{
+		u64 group = slot & ~(Width - 1);
+		if (Private::ControlGroup(m_Ctrl + group).MatchEmpty())
+		{
+			m_Ctrl[slot] = Private::CtrlEmpty;
+			m_GrowthLeft++;
+		}
+		else
+		{
+			m_Ctrl[slot] = Private::CtrlDeleted;
+		}
+	}
+
+	/// Throw away the index, and index every entry again.
+	///
+	/// \param capacity Number of slots of the new index. Must be a power of 2, and at least Width.
+	void Rebuild(u64 capacity)
+	{
+		if (capacity != m_Capacity)
+		{
+			FreeIndex();
+			AllocateIndex(capacity);
+		}
+		else
+		{
+			MemSet(m_Ctrl, Private::CtrlEmpty, m_Capacity);
+		}
+
+		for (u64 i = 0; i < m_Entries.Size(); i++)
+		{
+			u64 hash = Hasher<K>::Hash(m_Entries[i].First);
+			u64 slot = FindFree(hash);
+			m_Ctrl[slot] = u8(hash & 0x7F);
+			m_Indices[slot] = u32(i);
+		}
+		m_GrowthLeft = MaxLoad(m_Capacity) - m_Entries.Size();
+	}
+
+	/// Allocate an empty index. The control bytes are followed by the indices, in the same allocation.
+	void AllocateIndex(u64 capacity)
+	{
+		auto memory = reinterpret_cast<u8*>(m_Alloc->Allocate(capacity * (1 + sizeof(u32)), Width));
+		m_Ctrl = memory;
+		m_Indices = reinterpret_cast<u32*>(memory + capacity);
+		m_Capacity = capacity;
+		m_GrowthLeft = MaxLoad(capacity);
+		MemSet(m_Ctrl, Private::CtrlEmpty, capacity);
+	}
+
+	void FreeIndex()
+	{
+		if (!m_Capacity)
+		{
+			return;
+		}
+
+		m_Alloc->Deallocate(m_Ctrl, m_Capacity * (1 + sizeof(u32)));
+		m_Ctrl = const_cast<u8*>(Private::EmptyGroup);
+		m_Indices = nullptr;
+		m_Capacity = 0;
+		m_GrowthLeft = 0;
+	}
+
+	/// The index only holds positions of entries, so it can be copied as is.
+	void CopyIndex(const DenseHashMap& other)
+	{
+		if (!other.m_Capacity)
+		{
+			return;
+		}
+
+		AllocateIndex(other.m_Capacity);
+		MemCopy(m_Ctrl, other.m_Ctrl, m_Capacity * (1 + sizeof(u32)));
+		m_GrowthLeft = other.m_GrowthLeft;
+	}
+
+	void TakeIndex(DenseHashMap& other)
+	{
+		m_Ctrl = other.m_Ctrl;
+		m_Indices = other.m_Indices;
+		m_Capacity = other.m_Capacity;
+		m_GrowthLeft = other.m_GrowthLeft;
+
+		other.m_Ctrl = const_cast<u8*>(Private::EmptyGroup);
+		other.m_Indices = nullptr;
+		other.m_Capacity = 0;
+		other.m_GrowthLeft = 0;
+	}
+
+	Allocator* m_Alloc;
+	Array<Pair<K, V>> m_Entries;
+
+	/// Control byte of every slot of the index. Points to Private::EmptyGroup while m_Capacity is 0.
+	u8* m_Ctrl = const_cast<u8*>(Private::EmptyGroup);
+	u32* m_Indices = nullptr;
+
+	u64 m_Capacity = 0;
+
+	/// Number of empty slots that can be filled before the index must be rebuilt.
+	u64 m_GrowthLeft = 0;
+};
+
+namespace Traits {
+
+template<typename K, typename V>
+struct IsTriviallyRelocatable<DenseHashMap<K, V>> : std::true_type
+{
+};
+
+}
+
+}
@@ -0,0 +1,508 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Sorted maps and sets, backed by an Array.
+
+#pragma once
+#include <algorithm>
+
+#include "Core/Types/Array.h"
+#include "Core/Types/Pair.h"
+
+namespace Ignis {
+
+template<typename T>
+concept OrderedKey = requires(const T& first, const T& second)
+{
+	{ first < second } -> std::convertible_to<bool>;
+};
+
+/// Types that can be looked up in a sorted container with keys of type K, without being converted to K.
+/// Any type other than K needs K to be marked with Traits::IsTransparentlyOrdered, and must order the same way as the
+/// key it would convert to.
+template<typename Q, typename K>
+concept OrderedLookup = std::same_as<Q, K> || (Traits::IsTransparentlyOrdered<K>::value &&
+	requires(const Q& query, const K& key)
+	{
+		{ query < key } -> std::convertible_to<bool>;
+		{ key < query } -> std::convertible_to<bool>;
+	});
+
+namespace Private {
+
+/// Sort the elements past the first sorted ones, and merge them in.
+/// Only the last of equal elements is kept, so elements added later replace the ones already there.
+template<typename T, typename L>
+void MergeSorted(Array<T>& array, u64 sorted, L less)
+{
+	std::stable_sort(array.begin() + sorted, array.end(), less);
+	std::inplace_merge(array.begin(), array.begin() + sorted, array.end(), less);
+
+	u64 size = 0;
+	for (u64 i = 0; i < array.Size(); i++)
+	{
+		if (i + 1 < array.Size() && !less(array[i], array[i + 1]))
+		{
+			continue;
+		}
+
+		if (size != i)
+		{
+			array[size] = static_cast<T&&>(array[i]);
+		}
+		size++;
+	}
+
+	while (array.Size() > size)
+	{
+		array.RemoveSwap(array.Size() - 1);
+	}
+}
+
+}
+
+/// Map stored as an Array of pairs sorted by key, for small maps that are mostly read.
+/// Lookups are a binary search over contiguous memory, and there is no per-entry overhead,
+/// so it is smaller and usually faster than a HashMap for up to a few hundred entries.
+///
+/// Inserting one entry moves every entry after it, so build large maps with InsertBatch() instead.
+/// Iteration is in key order.
+///
+/// \tparam K Key type.
+/// \tparam V Value type.
+template<OrderedKey K, typename V>
+class FlatMap
+{
+public:
+	using Iterator = Pair<K, V>*;
+	using ConstIterator = const Pair<K, V>*;
+
+	/// Constructor.
+	///
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	FlatMap(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Entries(alloc) {}
+
+	/// Construct a FlatMap from a list of key-value pairs, sorting once.
+	/// Later pairs overwrite earlier ones with the same key.
+	///
+	/// \param list Pairs to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	FlatMap(const std::initializer_list<Pair<K, V>>& list,
+		Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Entries(list, alloc)
+	{
+		Private::MergeSorted(m_Entries, 0, &Less);
+	}
+
+	/// Construct a FlatMap from key-value pairs, sorting once.
+	/// Later pairs overwrite earlier ones with the same key.
+	///
+	/// \param pairs Pairs to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	FlatMap(ArrayRef<Pair<K, V>> pairs, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Entries(pairs, alloc)
+	{
+		Private::MergeSorted(m_Entries, 0, &Less);
+	}
+
+	/// Get the value stored at a key, default constructing it if the key doesn't exist.
+	///
+	/// \param key The key.
+	///
+	/// \return Reference to the value.
+	V& operator[](const K& key)
+	{
+		u64 index = LowerBound(key);
+		if (index == m_Entries.Size() || key < m_Entries[index].First)
+		{
+			m_Entries.Insert(index, { key, V() });
+		}
+
+		return m_Entries[index].Second;
+	}
+
+	/// Insert a key-value pair into the FlatMap.
+	/// If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	///
+	/// \return Reference to the key-value pair stored.
+	Pair<K, V>& Insert(const K& key, const V& value)
+	{
+		u64 index = LowerBound(key);
+		if (index != m_Entries.Size() && !(key < m_Entries[index].First))
+		{
+			m_Entries[index].Second = value;
+			return m_Entries[index];
+		}
+
+		return m_Entries.Insert(index, { key, value });
+	}
+
+	/// Insert a key-value pair into the FlatMap.
+	/// If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	///
+	/// \return Reference to the key-value pair stored.
+	Pair<K, V>& Insert(K&& key, V&& value)
+	{
+		u64 index = LowerBound(key);
+		if (index != m_Entries.Size() && !(key < m_Entries[index].First))
+		{
+			m_Entries[index].Second = static_cast<V&&>(value);
+			return m_Entries[index];
+		}
+
+		return m_Entries.Insert(index, { static_cast<K&&>(key), static_cast<V&&>(value) });
+	}
+
+	/// Insert many key-value pairs, sorting once instead of moving entries for every pair.
+	/// Later pairs overwrite earlier ones and the ones already in the FlatMap with the same key.
+	///
+	/// \param pairs Pairs to insert. Must not be from this FlatMap.
+	void InsertBatch(ArrayRef<Pair<K, V>> pairs)
+	{
+		u64 sorted = m_Entries.Size();
+		m_Entries.Append(pairs);
+		Private::MergeSorted(m_Entries, sorted, &Less);
+	}
+
+	/// Get the value stored at a key.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	V* Get(const K& key) { return Get<K>(key); }
+
+	/// Get the value stored at a key.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	const V* Get(const K& key) const { return Get<K>(key); }
+
+	/// Get the value stored at a key, without converting the key to K.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	template<OrderedLookup<K> Q>
+	V* Get(const Q& key)
+	{
+		u64 index = Find(key);
+		return index == NotFound ? nullptr : &m_Entries[index].Second;
+	}
+
+	/// Get the value stored at a key, without converting the key to K.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	template<OrderedLookup<K> Q>
+	const V* Get(const Q& key) const
+	{
+		u64 index = Find(key);
+		return index == NotFound ? nullptr : &m_Entries[index].Second;
+	}
+
+	/// Remove an entry from the FlatMap.
+	///
+	/// \param key Entry to remove.
+	void Remove(const K& key) { Remove<K>(key); }
+
+	/// Remove an entry from the FlatMap, without converting the key to K.
+	///
+	/// \param key Entry to remove.
+	template<OrderedLookup<K> Q>
+	void Remove(const Q& key)
+	{
+		u64 index = Find(key);
+		if (index != NotFound)
+		{
+			m_Entries.Remove(index);
+		}
+	}
+
+	/// Reserve space for entries.
+	///
+	/// \param count Number of entries to make space for, including the ones already in the FlatMap.
+	void Reserve(u64 count) { m_Entries.Reserve(count); }
+
+	/// Shrink the allocation to fit the entries.
+	void ShrinkToFit() { m_Entries.ShrinkToFit(); }
+
+	/// Remove every entry. Keeps the allocation around.
+	void Clear() { m_Entries.Clear(); }
+
+	/// Get the number of entries in the FlatMap.
+	///
+	/// \return The number of entries.
+	u64 Size() const { return m_Entries.Size(); }
+
+	/// Get the capacity of the FlatMap before a reallocation is done.
+	///
+	/// \return The number of entries that can be stored until a reallocation must be done.
+	u64 Capacity() const { return m_Entries.Capacity(); }
+
+	/// Get the entries, sorted by key.
+	///
+	/// \return The entries.
+	ArrayRef<Pair<K, V>> Entries() { return m_Entries; }
+
+	/// Iteration.
+	///
+	/// \return Begin Iterator.
+	Iterator begin() { return m_Entries.begin(); }
+
+	/// Iteration.
+	///
+	/// \return Begin Iterator.
+	ConstIterator begin() const { return m_Entries.begin(); }
+
+	/// Iteration.
+	///
+	/// \return End Iterator.
+	Iterator end() { return m_Entries.end(); }
+
+	/// Iteration.
+	///
+	/// \return End Iterator.
+	ConstIterator end() const { return m_Entries.end(); }
+
+private:
+	static constexpr u64 NotFound = u64(-1);
+
+	static bool Less(const Pair<K, V>& first, const Pair<K, V>& second) { return first.First < second.First; }
+
+	/// Index of the first entry not less than a key.
+	template<typename Q>
+	u64 LowerBound(const Q& key) const
+	{
+		u64 low = 0;
+		u64 high = m_Entries.Size();
+		while (low < high)
+		{
+			u64 mid = low + (high - low) / 2;
+			if (m_Entries[mid].First < key)
+			{
+				low = mid + 1;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+
+		return low;
+	}
+
+	template<typename Q>
+	u64 Find(const Q& key) const
+	{
+		u64 index = LowerBound(key);
+		return index != m_Entries.Size() && !(key < m_Entries[index].First) ? index : NotFound;
+	}
+
+	Array<Pair<K, V>> m_Entries;
+};
+
+/// Set stored as a sorted Array of keys, for small sets that are mostly read. See FlatMap.
+///
+/// \tparam K Key type.
+template<OrderedKey K>
+class FlatSet
+{
+public:
+	using Iterator = const K*;
+	using ConstIterator = const K*;
+
+	/// Constructor.
+	///
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	FlatSet(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Keys(alloc) {}
+
+	/// Construct a FlatSet from a list of keys, sorting once.
+	///
+	/// \param list Keys to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	FlatSet(const std::initializer_list<K>& list,
+		Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Keys(list, alloc)
+	{
+		Private::MergeSorted(m_Keys, 0, &Less);
+	}
+
+	/// Construct a FlatSet from keys, sorting once.
+	///
+	/// \param keys Keys to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	FlatSet(ArrayRef<K> keys, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Keys(keys, alloc)
+	{
+		Private::MergeSorted(m_Keys, 0, &Less);
+	}
+
+	/// Insert a key into the FlatSet.
+	///
+	/// \param key The key.
+	///
+	/// \return If the key was inserted, and wasn't in the FlatSet already.
+	bool Insert(const K& key)
+	{
+		u64 index = LowerBound(key);
+		if (index != m_Keys.Size() && !(key < m_Keys[index]))
+		{
+			return false;
+		}
+
+		m_Keys.Insert(index, key);
+		return true;
+	}
+
+	/// Insert a key into the FlatSet.
+	///
+	/// \param key The key.
+	///
+	/// \return If the key was inserted, and wasn't in the FlatSet already.
+	bool Insert(K&& key)
+	{
+		u64 index = LowerBound(key);
+		if (index != m_Keys.Size() && !(key < m_Keys[index]))
+		{
+			return false;
+		}
+
+		m_Keys.Insert(index, static_cast<K&&>(key));
+		return true;
+	}
+
+	/// Insert many keys, sorting once instead of moving keys for every insert.
+	///
+	/// \param keys Keys to insert. Must not be from this FlatSet.
+	void InsertBatch(ArrayRef<K> keys)
+	{
+		u64 sorted = m_Keys.Size();
+		m_Keys.Append(keys);
+		Private::MergeSorted(m_Keys, sorted, &Less);
+	}
+
+	/// Check if a key is in the FlatSet.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return If the key is in the FlatSet.
+	bool Contains(const K& key) const { return Contains<K>(key); }
+
+	/// Check if a key is in the FlatSet, without converting the key to K.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return If the key is in the FlatSet.
+	template<OrderedLookup<K> Q>
+	bool Contains(const Q& key) const
+	{
+		u64 index = LowerBound(key);
+		return index != m_Keys.Size() && !(key < m_Keys[index]);
+	}
+
+	/// Remove a key from the FlatSet.
+	///
+	/// \param key Key to remove.
+	///
+	/// \return If the key was in the FlatSet.
+	bool Remove(const K& key) { return Remove<K>(key); }
+
+	/// Remove a key from the FlatSet, without converting the key to K.
+	///
+	/// \param key Key to remove.
+	///
+	/// \return If the key was in the FlatSet.
+	template<OrderedLookup<K> Q>
+	bool Remove(const Q& key)
+	{
+		u64 index = LowerBound(key);
+		if (index == m_Keys.Size() || key < m_Keys[index])
+		{
+			return false;
+		}
+
+		m_Keys.Remove(index);
+		return true;
+	}
+
+	/// Reserve space for keys.
+	///
+	/// \param count Number of keys to make space for, including the ones already in the FlatSet.
+	void Reserve(u64 count) { m_Keys.Reserve(count); }
+
+	/// Shrink the allocation to fit the keys.
+	void ShrinkToFit() { m_Keys.ShrinkToFit(); }
+
+	/// Remove every key. Keeps the allocation around.
+	void Clear() { m_Keys.Clear(); }
+
+	/// Get the number of keys in the FlatSet.
+	///
+	/// \return The number of keys.
+	u64 Size() const { return m_Keys.Size(); }
+
+	/// Get the capacity of the FlatSet before a reallocation is done.
+	///
+	/// \return The number of keys that can be stored until a reallocation must be done.
+	u64 Capacity() const { return m_Keys.Capacity(); }
+
+	/// Iteration, in order. Keys can't be changed in place, as that could break the order.
+	///
+	/// \return Begin Iterator.
+	ConstIterator begin() const { return m_Keys.begin(); }
+
+	/// Iteration.
+	///
+	/// \return End Iterator.
+	ConstIterator end() const { return m_Keys.end(); }
+
+private:
+	static bool Less(const K& first, const K& second) { return first < second; }
+
+	/// Index of the first key not less than a key.
+	template<typename Q>
+	u64 LowerBound(const Q& key) const
+	{
+		u64 low = 0;
+		u64 high = m_Keys.Size();
+		while (low < high)
+		{
+			u64 mid = low + (high - low) / 2;
+			if (m_Keys[mid] < key)
+			{
+				low = mid + 1;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+
+		return low;
+	}
+
+	Array<K> m_Keys;
+};
+
+namespace Traits {
+
+template<typename K, typename V>
+struct IsTriviallyRelocatable<FlatMap<K, V>> : std::true_type
+{
+};
+
+template<typename K>
+struct IsTriviallyRelocatable<FlatSet<K>> : std::true_type
+{
+};
+
+}
+
+}
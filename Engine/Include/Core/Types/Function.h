@@ -38,9 +38,14 @@ public:
 	/// \param size Size of the memory region, in bytes.
 	/// \param alloc Allocator to use to allocate memory for the callable if it does not fit in size bytes.
 	///
-	/// \return Pointer to the allocated callable. Free with Delete() if not equal to at.
+	/// \return Pointer to the allocated callable. Free with Free() if not equal to at.
 	virtual Callable* Clone(void* at, u64 size, Allocator& alloc = GAlloc) const = 0;
 
+	/// Destroy a callable allocated by Clone(), and free its memory.
+	///
+	/// \param alloc Allocator the callable was allocated from.
+	virtual void Free(Allocator& alloc) = 0;
+
 	using Type = Ret(Args...);
 };
 
@@ -66,9 +71,11 @@ public:
 			return Construct<FCallable<Ret(Args...), T>>(at, m_Callable);
 		}
 
-		return New<FCallable<Ret(Args...), T>>(alloc, m_Callable);
+		return Create<FCallable<Ret(Args...), T>>(alloc, m_Callable);
 	}
 
+	void Free(Allocator& alloc) override { Destroy(alloc, this); }
+
 private:
 	T m_Callable;
 };
@@ -98,9 +105,11 @@ public:
 			return Construct<MCallable<Ret(Args...), T>>(at, m_Function, m_Object);
 		}
 
-		return New<MCallable<Ret(Args...), T>>(alloc, m_Function, m_Object);
+		return Create<MCallable<Ret(Args...), T>>(alloc, m_Function, m_Object);
 	}
 
+	void Free(Allocator& alloc) override { Destroy(alloc, this); }
+
 private:
 	T* m_Object;
 	Ret (T::*m_Function)(Args...);
@@ -158,9 +167,10 @@ public:
 	template<typename T>
 	Function(const T& callable, Allocator& alloc = GAlloc)
 	{
-		if (sizeof(T) > sizeof(m_Repr))
+		if (sizeof(Private::FCallable<Ret(Args...), T>) > sizeof(m_Repr))
 		{
-			m_Repr.External = New<Private::FCallable<Ret(Args...), T>>(alloc, callable);
+			m_Repr.External = Create<Private::FCallable<Ret(Args...), T>>(alloc, callable);
+			m_Alloc = &alloc;
 		}
 		else
 		{
@@ -172,9 +182,10 @@ public:
 	template<typename T>
 	Function(Ret (T::*function)(Args...), T* object, Allocator& alloc = GAlloc)
 	{
-		if (sizeof(T) > sizeof(m_Repr))
+		if (sizeof(Private::MCallable<Ret(Args...), T>) > sizeof(m_Repr))
 		{
-			m_Repr.External = New<Private::MCallable<Ret(Args...), T>>(alloc, function, object);
+			m_Repr.External = Create<Private::MCallable<Ret(Args...), T>>(alloc, function, object);
+			m_Alloc = &alloc;
 		}
 		else
 		{
@@ -186,6 +197,7 @@ public:
 	Function(Function<Ret(Args...)>&& other)
 	{
 		m_Repr = other.m_Repr;
+		m_Alloc = other.m_Alloc;
 		m_IsSmall = other.m_IsSmall;
 		other.m_IsSmall = true;
 	}
@@ -200,6 +212,7 @@ public:
 		else
 		{
 			m_Repr.External = callable;
+			m_Alloc = &alloc;
 		}
 	}
 
@@ -207,7 +220,7 @@ public:
 	{
 		if (!m_IsSmall)
 		{
-			Delete(m_Repr.External);
+			m_Repr.External->Free(*m_Alloc);
 		}
 	}
 
@@ -235,6 +248,9 @@ private:
 		u64 Internal[3];
 		Private::Callable<Ret(Args...)>* External = nullptr;
 	} m_Repr;
+
+	/// Allocator the callable was allocated from, if it is not small.
+	Allocator* m_Alloc = nullptr;
 	bool m_IsSmall = false;
 };
 
@@ -0,0 +1,110 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Hash functions, and Hashers for basic types.
+
+#pragma once
+#include "Core/Types/BaseTypes.h"
+#include "Core/Types/Pair.h"
+#include "Core/Types/Traits.h"
+
+#ifdef COMPILER_MSVC
+#	include <intrin.h>
+#endif
+
+namespace Ignis {
+
+/// Hashes keys for hash tables. Specialize it with a static Hash function taking a key and returning a u64.
+/// Hash tables index with the low bits of the hash, so every bit of the output must depend on every bit of the key.
+/// MixHash() and HashBytes() can be used to get there.
+template<typename>
+struct Hasher;
+
+namespace Private {
+
+/// Multiply two 64-bit integers, and fold the 128-bit product into 64 bits.
+constexpr u64 MulFold(u64 first, u64 second)
+{
+#ifdef COMPILER_MSVC
+	if (!std::is_constant_evaluated())
+	{
+		return (first * second) ^ __umulh(first, second);
+	}
+
+	u64 lowLow = (first & 0xFFFFFFFF) * (second & 0xFFFFFFFF);
+	u64 highLow = (first >> 32) * (second & 0xFFFFFFFF);
+	u64 lowHigh = (first & 0xFFFFFFFF) * (second >> 32);
+	u64 cross = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + lowHigh;
+	u64 high = (first >> 32) * (second >> 32) + (highLow >> 32) + (cross >> 32);
+	return (first * second) ^ high;
+#else
+	unsigned __int128 product = static_cast<unsigned __int128>(first) * second;
+	return u64(product) ^ u64(product >> 64);
+#endif
+}
+
+}
+
+/// Mix the bits of an integer, so every bit of the result depends on every bit of the input.
+/// Costs a single wide multiply.
+///
+/// \param value The integer to mix.
+///
+/// \return The mixed integer.
+constexpr u64 MixHash(u64 value) { return Private::MulFold(value ^ 0x2D358DCCAA6C78A5, 0x8BB84B93962EACC9); }
+
+/// Combine two hashes, for hashing aggregates. The order of the hashes matters.
+///
+/// \param first Hash of the first element.
+/// \param second Hash of the second element.
+///
+/// \return The combined hash.
+constexpr u64 CombineHash(u64 first, u64 second)
+{
+	return Private::MulFold(first ^ 0x4B33A62ED433D4A3, second ^ 0x4D5A2DA51DE1AA47);
+}
+
+/// Hash a region of memory with wyhash:
+/// https://github.com/wangyi-fudan/wyhash
+///
+/// \param data Start of the region.
+/// \param size Size of the region in bytes.
+/// \param seed Seed of the hash.
+///
+/// \return The hash.
+IGNIS_API u64 HashBytes(const void* data, u64 size, u64 seed = 0);
+
+/// Hasher for integers and characters.
+template<typename T>
+requires std::is_integral_v<T>
+struct Hasher<T>
+{
+	static u64 Hash(T value) { return MixHash(u64(value)); }
+};
+
+/// Hasher for enums, hashes the underlying integer.
+template<typename T>
+requires std::is_enum_v<T>
+struct Hasher<T>
+{
+	static u64 Hash(T value) { return MixHash(u64(value)); }
+};
+
+/// Hasher for pointers. Hashes the address, not what is pointed to.
+template<typename T>
+struct Hasher<T*>
+{
+	static u64 Hash(const T* value) { return MixHash(reinterpret_cast<u64>(value)); }
+};
+
+/// Hasher for Pairs of hashable types.
+template<typename F, typename S>
+requires Traits::IsComplete<Hasher<F>>::value && Traits::IsComplete<Hasher<S>>::value
+struct Hasher<Pair<F, S>>
+{
+	static u64 Hash(const Pair<F, S>& pair)
+	{
+		return CombineHash(Hasher<F>::Hash(pair.First), Hasher<S>::Hash(pair.Second));
+	}
+};
+
+}
@@ -4,292 +4,766 @@
 
 #pragma once
 #include "Core/Memory/Memory.h"
+#include "Core/Memory/MemoryTag.h"
 #include "Core/Memory/RawAllocator.h"
+#include "Core/Misc/Assert.h"
+#include "Core/Types/Array.h"
 #include "Core/Types/BaseTypes.h"
+#include "Core/Types/Hash.h"
 #include "Core/Types/Pair.h"
 #include "Core/Types/Traits.h"
 
-namespace Ignis {
+#ifdef ARCH_X64
+#	include <emmintrin.h>
+#endif
+#ifdef COMPILER_MSVC
+#	include <intrin.h>
+#endif
 
-template<typename>
-struct Hasher;
+namespace Ignis {
 
 template<typename T>
 concept HashKey = std::equality_comparable<T>&& Traits::IsComplete<Hasher<T>>::value;
 // Some strange formatting by clang-format --^^
 
-/// Open-addressed, quadratic-probed HashMap.
-///
-/// \tparam K Key type.
-/// \tparam V Value type.
-template<HashKey K, typename V>
-class HashMap
+/// Types that can be looked up in a HashMap with keys of type K, without being converted to K.
+/// Any type other than K needs the Hasher of K to be marked as transparent with an IsTransparent member type,
+/// and must hash equal to the key it compares equal to.
+template<typename Q, typename K>
+concept HashLookup = std::same_as<Q, K> || (requires { typename Hasher<K>::IsTransparent; } &&
+	requires(const Q& query, const K& key)
+	{
+		{ Hasher<K>::Hash(query) } -> std::same_as<u64>;
+		{ key == query } -> std::convertible_to<bool>;
+	});
+
+namespace Private {
+
+/// Control byte of an empty slot.
+constexpr u8 CtrlEmpty = 0x80;
+
+/// Control byte of a slot whose entry was removed, and that probes must continue past.
+constexpr u8 CtrlDeleted = 0xFE;
+
+/// Control bytes of a table with no slots, so that empty tables don't need an allocation.
+alignas(16) inline constexpr u8 EmptyGroup[16] = { CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty,
+	CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty, CtrlEmpty };
+
+inline u32 CountTrailingZeros(u32 value)
 {
-private:
-	struct Bucket
+#ifdef COMPILER_MSVC
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+/// 16 control bytes, matched against all at once. Each bit of a returned mask is a slot in the group.
+/// Full slots hold the low 7 bits of their hash, and empty and deleted slots have the top bit set.
+class ControlGroup
+{
+public:
+	static constexpr u64 Width = 16;
+
+	/// Load a group.
+	///
+	/// \param ctrl First control byte of the group. Must be aligned to 16 bytes.
+	explicit ControlGroup(const u8* ctrl)
+	{
+#ifdef ARCH_X64
+		m_Ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+		m_Ctrl = ctrl;
+#endif
+	}
+
+	/// Match full slots with a hash.
+	///
+	/// \param hash Low 7 bits of the hash.
+	u32 Match(u8 hash) const
 	{
-		Pair<K, V> Slot;
-		enum
+#ifdef ARCH_X64
+		return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(m_Ctrl, _mm_set1_epi8(char(hash)))));
+#else
+		u32 mask = 0;
+		for (u32 i = 0; i < Width; i++)
 		{
-			Full,
-			Empty,
-			Tombstone
-		} Status;
-	};
+			mask |= u32(m_Ctrl[i] == hash) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// Match empty slots.
+	u32 MatchEmpty() const { return Match(CtrlEmpty); }
+
+	/// Match empty and deleted slots.
+	u32 MatchFree() const
+	{
+#ifdef ARCH_X64
+		return u32(_mm_movemask_epi8(m_Ctrl));
+#else
+		u32 mask = 0;
+		for (u32 i = 0; i < Width; i++)
+		{
+			mask |= u32(m_Ctrl[i] >> 7) << i;
+		}
+		return mask;
+#endif
+	}
+
+private:
+#ifdef ARCH_X64
+	__m128i m_Ctrl;
+#else
+	const u8* m_Ctrl;
+#endif
+};
 
+/// Iterator over the full slots of a HashTable.
+///
+/// \tparam T Slot type. Const for const iteration.
+template<typename T>
+class HashTableIterator
+{
 public:
-	/// Iterator over a HashMap.
-	class Iterator
+	HashTableIterator(const u8* ctrl, T* slot, T* end) : m_Ctrl(ctrl), m_Slot(slot), m_End(end) {}
+
+	/// Dereference the iterator.
+	///
+	/// \return The slot it is pointing to.
+	T& operator*() const { return *m_Slot; }
+
+	/// Dereference the iterator.
+	///
+	/// \return The slot it is pointing to.
+	T* operator->() const { return m_Slot; }
+
+	/// Advance the iterator.
+	///
+	/// \return Reference to the advanced iterator.
+	HashTableIterator& operator++()
 	{
-	public:
-		Iterator(Bucket* bucket, Bucket* end) : m_Bucket(bucket), m_End(end) {}
+		do
+		{
+			m_Ctrl++;
+			m_Slot++;
+		} while (m_Slot != m_End && (*m_Ctrl & 0x80));
 
-		/// Dereference the iterator.
-		///
-		/// \return The pair it is pointing to.
-		Pair<K, V>& operator*() const { return m_Bucket->Slot; }
+		return *this;
+	}
 
-		/// Dereference the iterator.
-		///
-		/// \return The pair it is pointing to.
-		Pair<K, V>* operator->() const { return &m_Bucket->Slot; }
+	/// Advance the iterator.
+	///
+	/// \return The advanced iterator.
+	HashTableIterator operator++(int)
+	{
+		HashTableIterator it = *this;
+		++*this;
+		return it;
+	}
+
+	/// Advance the iterator.
+	///
+	/// \param offset Number of slots to iterate over.
+	///
+	/// \return The advanced iterator.
+	HashTableIterator operator+(u64 offset) const
+	{
+		HashTableIterator it = *this;
+		it += offset;
+		return it;
+	}
 
-		/// Advance the iterator.
-		///
-		/// \return Reference to the advanced iterator.
-		Iterator& operator++()
+	/// Advance the iterator.
+	///
+	/// \param offset Number of slots to iterate over.
+	///
+	/// \return Reference to the advanced iterator.
+	HashTableIterator& operator+=(u64 offset)
+	{
+		for (u64 i = 0; i < offset; i++)
 		{
-			do
-			{
-				m_Bucket++;
-			} while (m_Bucket->Status != Bucket::Full && m_Bucket != m_End);
+			++*this;
+		}
+
+		return *this;
+	}
+
+	friend bool operator==(HashTableIterator first, HashTableIterator second) { return first.m_Slot == second.m_Slot; }
+
+	friend bool operator!=(HashTableIterator first, HashTableIterator second) { return !(first == second); }
+
+private:
+	const u8* m_Ctrl;
+	T* m_Slot;
+	T* m_End;
+};
+
+/// Swiss table shared by HashMap and HashSet.
+/// Every slot has a control byte holding 7 bits of its hash, kept in an array apart from the slots.
+/// Lookups compare 16 control bytes at once, with SSE2 where available, and only touch the slots whose
+/// control byte matches, so a lookup usually costs a single cache miss into the slots.
+///
+/// The table only finds and frees slots. Containers construct and destroy what is in them.
+///
+/// \tparam K Key type.
+/// \tparam T Slot type. Either K itself, or a Pair with K as its first element.
+template<typename K, typename T>
+class HashTable
+{
+public:
+	using Iterator = HashTableIterator<T>;
+	using ConstIterator = HashTableIterator<const T>;
 
-			return *this;
+	static constexpr u64 NotFound = u64(-1);
+
+	/// Constructor. Does not allocate until the first slot is filled.
+	///
+	/// \param alloc Allocator to use.
+	HashTable(Allocator& alloc) : m_Alloc(&alloc) {}
+
+	HashTable(const HashTable& other) : m_Alloc(other.m_Alloc) { CopyFrom(other); }
+
+	HashTable(HashTable&& other) : m_Alloc(other.m_Alloc) { TakeFrom(other); }
+
+	~HashTable() { Free(); }
+
+	HashTable& operator=(const HashTable& other)
+	{
+		if (this != &other)
+		{
+			Free();
+			m_Alloc = other.m_Alloc;
+			CopyFrom(other);
 		}
 
-		/// Advance the iterator.
-		///
-		/// \return The advanced iterator.
-		Iterator operator++(int)
+		return *this;
+	}
+
+	HashTable& operator=(HashTable&& other)
+	{
+		if (this != &other)
 		{
-			Iterator it = *this;
+			Free();
+			m_Alloc = other.m_Alloc;
+			TakeFrom(other);
+		}
 
-			do
-			{
-				m_Bucket++;
-			} while (m_Bucket->Status != Bucket::Full && m_Bucket != m_End);
+		return *this;
+	}
 
-			return it;
+	/// Get the key of a slot.
+	static const K& KeyOf(const T& slot)
+	{
+		if constexpr (std::is_same_v<T, K>)
+		{
+			return slot;
+		}
+		else
+		{
+			return slot.First;
 		}
+	}
 
-		/// Advance the iterator.
-		///
-		/// \param offset Number of pairs to iterate over.
-		///
-		/// \return Reference to the advanced iterator.
-		Iterator operator+(u64 offset) const
+	/// Find the slot of a key.
+	///
+	/// \return Index of the slot, or NotFound.
+	template<typename Q>
+	u64 Find(const Q& key, u64 hash) const
+	{
+		u8 tag = u8(hash & 0x7F);
+		u64 groupMask = m_Capacity ? m_Capacity / Width - 1 : 0;
+		u64 group = (hash >> 7) & groupMask;
+
+		// Triangular probing visits every group once, as the number of groups is a power of 2.
+		for (u64 step = 1; step <= groupMask + 1; step++)
 		{
-			Iterator it = *this;
+			ControlGroup ctrl(m_Ctrl + group * Width);
+			for (u32 mask = ctrl.Match(tag); mask; mask &= mask - 1)
+			{
+				u64 index = group * Width + CountTrailingZeros(mask);
+				if (KeyOf(m_Slots[index]) == key)
+				{
+					return index;
+				}
+			}
 
-			for (u64 i = 0; i < offset; i++)
+			if (ctrl.MatchEmpty())
 			{
-				it++;
+				return NotFound;
 			}
 
-			return it;
+			group = (group + step) & groupMask;
 		}
 
-		/// Advance the iterator.
-		///
-		/// \param offset Number of pairs to iterate over.
-		///
-		/// \return The advanced iterator.
-		Iterator& operator+=(u64 offset)
+		return NotFound;
+	}
+
+	/// Find a free slot for a key that isn't in the table, and mark it as full. Grows the table if needed.
+	/// The caller must construct the slot right after.
+	///
+	/// \return Index of the slot.
+	u64 PrepareInsert(u64 hash)
+	{
+		u64 index = FindFree(hash);
+		if (!m_GrowthLeft && m_Ctrl[index] != CtrlDeleted)
 		{
-			for (u64 i = 0; i < offset; i++)
-			{
-				(*this)++;
-			}
+			Grow();
+			index = FindFree(hash);
+		}
 
-			return *this;
+		if (m_Ctrl[index] == CtrlEmpty)
+		{
+			m_GrowthLeft--;
 		}
+		m_Ctrl[index] = u8(hash & 0x7F);
+		m_Size++;
 
-		friend bool operator==(Iterator first, Iterator second) { return first.m_Bucket == second.m_Bucket; }
+		return index;
+	}
 
-		friend bool operator!=(Iterator first, Iterator second) { return !(first == second); }
+	/// Destroy a slot, and mark it as free.
+	void Erase(u64 index)
+	{
+		m_Slots[index].~T();
+		m_Size--;
 
-	private:
-		Bucket* m_Bucket;
-		Bucket* m_End;
-	};
+		// A probe only moves on from a group if it has no empty slots, so if this group has one,
+		// no probe has ever gone past it and the slot can be freed for good.
+		u64 group = index & ~(Width - 1);
+		if (ControlGroup(m_Ctrl + group).MatchEmpty())
+		{
+			m_Ctrl[index] = CtrlEmpty;
+			m_GrowthLeft++;
+		}
+		else
+		{
+			m_Ctrl[index] = CtrlDeleted;
+		}
+	}
 
-	/// ConstIterator over a HashMap.
-	class ConstIterator
-	{
-	public:
-		ConstIterator(const Bucket* bucket, const Bucket* end) : m_Bucket(bucket), m_End(end) {}
+	/// Get a slot.
+	T& operator[](u64 index) { return m_Slots[index]; }
 
-		/// Dereference the iterator.
-		///
-		/// \return The pair it is pointing to.
-		const Pair<K, V>& operator*() const { return m_Bucket->Slot; }
+	/// Get a slot.
+	const T& operator[](u64 index) const { return m_Slots[index]; }
 
-		/// Dereference the iterator.
-		///
-		/// \return The pair it is pointing to.
-		const Pair<K, V>* operator->() const { return &m_Bucket->Slot; }
+	/// Destroy every slot. Keeps the allocation around.
+	void Clear()
+	{
+		if (!m_Capacity)
+		{
+			return;
+		}
 
-		/// Advance the iterator.
-		///
-		/// \return Reference to the advanced iterator.
-		ConstIterator& operator++()
+		for (u64 i = 0; i < m_Capacity; i++)
 		{
-			do
+			if (!(m_Ctrl[i] & 0x80))
 			{
-				m_Bucket++;
-			} while (m_Bucket->Status != Bucket::Full && m_Bucket != m_End);
+				m_Slots[i].~T();
+			}
+		}
 
-			return *this;
+		MemSet(m_Ctrl, CtrlEmpty, m_Capacity);
+		m_Size = 0;
+		m_GrowthLeft = MaxLoad(m_Capacity);
+	}
+
+	/// Make sure slots can be filled without the table growing.
+	///
+	/// \param count Number of slots to make space for, including the full ones.
+	void Reserve(u64 count)
+	{
+		u64 capacity = CapacityFor(count);
+		if (capacity > m_Capacity)
+		{
+			Rehash(capacity);
 		}
+	}
 
-		/// Advance the iterator.
-		///
-		/// \return The advanced iterator.
-		ConstIterator operator++(int)
+	/// Shrink the table to the smallest capacity that fits its slots, freeing the allocation if it is empty.
+	void ShrinkToFit()
+	{
+		if (!m_Size)
 		{
-			Iterator it = *this;
+			Free();
+			return;
+		}
 
-			do
-			{
-				m_Bucket++;
-			} while (m_Bucket->Status != Bucket::Full && m_Bucket != m_End);
+		u64 capacity = CapacityFor(m_Size);
+		if (capacity < m_Capacity)
+		{
+			Rehash(capacity);
+		}
+		else
+		{
+			Purge();
+		}
+	}
 
-			return it;
+	/// Clear out deleted slots without reallocating.
+	void Purge()
+	{
+		if (MaxLoad(m_Capacity) - m_Size == m_GrowthLeft)
+		{
+			return;
 		}
 
-		/// Advance the iterator.
-		///
-		/// \param offset Number of pairs to iterate over.
-		///
-		/// \return Reference to the advanced iterator.
-		ConstIterator operator+(u64 offset) const
+		// Every full slot is marked deleted and every free slot empty, then slots are put back into place one by one.
+		// Deleted now means a slot that hasn't been placed yet.
+		for (u64 i = 0; i < m_Capacity; i++)
 		{
-			Iterator it = *this;
+			m_Ctrl[i] = (m_Ctrl[i] & 0x80) ? CtrlEmpty : CtrlDeleted;
+		}
 
-			for (u64 i = 0; i < offset; i++)
+		for (u64 i = 0; i < m_Capacity; i++)
+		{
+			if (m_Ctrl[i] != CtrlDeleted)
 			{
-				it++;
+				continue;
 			}
 
-			return it;
-		}
+			u64 hash = Hasher<K>::Hash(KeyOf(m_Slots[i]));
+			u64 index = FindFree(hash);
+			u8 tag = u8(hash & 0x7F);
 
-		/// Advance the iterator.
-		///
-		/// \param offset Number of pairs to iterate over.
-		///
-		/// \return The advanced iterator.
-		ConstIterator& operator+=(u64 offset)
-		{
-			for (u64 i = 0; i < offset; i++)
+			// Probes look at a whole group at once, so a slot already in the first group with a free slot stays.
+			if (index / Width == i / Width)
 			{
-				(*this)++;
+				m_Ctrl[i] = tag;
 			}
+			else if (m_Ctrl[index] == CtrlEmpty)
+			{
+				m_Ctrl[index] = tag;
+				m_Ctrl[i] = CtrlEmpty;
+				RelocateSlot(m_Slots + index, m_Slots + i);
+			}
+			else
+			{
+				// The slot holds one that hasn't been placed yet, so swap it in and place it next.
+				m_Ctrl[index] = tag;
+				alignas(T) u8 temp[sizeof(T)];
+				auto swap = reinterpret_cast<T*>(temp);
+				RelocateSlot(swap, m_Slots + index);
+				RelocateSlot(m_Slots + index, m_Slots + i);
+				RelocateSlot(m_Slots + i, swap);
+				i--;
+			}
+		}
+
+		m_GrowthLeft = MaxLoad(m_Capacity) - m_Size;
+	}
+
+	/// Get the number of full slots.
+	u64 Size() const { return m_Size; }
+
+	/// Get the number of slots that can be filled before the table grows.
+	u64 Capacity() const { return MaxLoad(m_Capacity); }
+
+	Iterator begin()
+	{
+		u64 index = FirstFull();
+		return Iterator(m_Ctrl + index, m_Slots + index, m_Slots + m_Capacity);
+	}
+
+	ConstIterator begin() const
+	{
+		u64 index = FirstFull();
+		return ConstIterator(m_Ctrl + index, m_Slots + index, m_Slots + m_Capacity);
+	}
+
+	Iterator end() { return Iterator(m_Ctrl + m_Capacity, m_Slots + m_Capacity, m_Slots + m_Capacity); }
+
+	ConstIterator end() const
+	{
+		return ConstIterator(m_Ctrl + m_Capacity, m_Slots + m_Capacity, m_Slots + m_Capacity);
+	}
+
+private:
+	static constexpr u64 Width = ControlGroup::Width;
+
+	/// Alignment of the allocation, which holds the control bytes followed by the slots.
+	static constexpr u64 Alignment = alignof(T) > Width ? alignof(T) : Width;
 
-			return *this;
+	/// Most slots a table can fill, at 7/8 load.
+	static u64 MaxLoad(u64 capacity) { return capacity - capacity / 8; }
+
+	/// Smallest capacity that can fill a number of slots.
+	static u64 CapacityFor(u64 count)
+	{
+		u64 capacity = Width;
+		while (MaxLoad(capacity) < count)
+		{
+			capacity *= 2;
 		}
 
-		friend bool operator==(ConstIterator first, ConstIterator second) { return first.m_Bucket == second.m_Bucket; }
+		return capacity;
+	}
 
-		friend bool operator!=(ConstIterator first, ConstIterator second) { return !(first == second); }
+	/// Move a slot to an uninitialized one, leaving the old one uninitialized.
+	static void RelocateSlot(T* to, T* from)
+	{
+		if constexpr (Traits::IsTriviallyRelocatable<T>::value)
+		{
+			MemCopy(to, from, sizeof(T));
+		}
+		else
+		{
+			Construct<T>(to, static_cast<T&&>(*from));
+			from->~T();
+		}
+	}
 
-	private:
-		const Bucket* m_Bucket;
-		const Bucket* m_End;
-	};
+	/// Offset of the slots from the start of the allocation.
+	static u64 SlotOffset(u64 capacity) { return (capacity + alignof(T) - 1) & ~(alignof(T) - 1); }
 
-	/// Constructor.
-	///
-	/// \param alloc Allocator to use. Defaults to GAlloc.
-	HashMap(Allocator& alloc = GAlloc) : m_Alloc(&alloc)
+	/// Find the first empty or deleted slot in the probe sequence of a hash.
+	u64 FindFree(u64 hash) const
 	{
-		m_Capacity = 8;
-		m_Mask = 7;
-		m_Buckets = reinterpret_cast<Bucket*>(m_Alloc->Allocate(sizeof(Bucket) * m_Capacity));
-		for (u64 i = 0; i < m_Capacity; i++)
+		if (!m_Capacity)
 		{
-			m_Buckets[i].Status = Bucket::Empty;
+			return 0;
+		}
+
+		u64 groupMask = m_Capacity / Width - 1;
+		u64 group = (hash >> 7) & groupMask;
+		for (u64 step = 1;; step++)
+		{
+			u32 mask = ControlGroup(m_Ctrl + group * Width).MatchFree();
+			if (mask)
+			{
+				return group * Width + CountTrailingZeros(mask);
+			}
+
+			group = (group + step) & groupMask;
 		}
 	}
 
-	/// Destructor.
-	~HashMap()
+	/// Grow the table, or just clear out deleted slots if they are most of the used ones.
+	void Grow()
 	{
-		for (u64 i = 0; i < m_Capacity; i++)
+		if (!m_Capacity)
+		{
+			Rehash(Width);
+		}
+		else if (m_Size * 2 < MaxLoad(m_Capacity))
+		{
+			Purge();
+		}
+		else
 		{
-			if (m_Buckets[i].Status == Bucket::Full)
+			Rehash(m_Capacity * 2);
+		}
+	}
+
+	/// Move every slot into a new table.
+	///
+	/// \param capacity Number of slots of the new table. Must be a power of 2, and at least Width.
+	void Rehash(u64 capacity)
+	{
+		u8* oldCtrl = m_Ctrl;
+		T* oldSlots = m_Slots;
+		u64 oldCapacity = m_Capacity;
+
+		Allocate(capacity);
+		for (u64 i = 0; i < oldCapacity; i++)
+		{
+			if (oldCtrl[i] & 0x80)
 			{
-				m_Buckets[i].Slot.~Pair<K, V>();
+				continue;
 			}
+
+			u64 hash = Hasher<K>::Hash(KeyOf(oldSlots[i]));
+			u64 index = FindFree(hash);
+			m_Ctrl[index] = u8(hash & 0x7F);
+			RelocateSlot(m_Slots + index, oldSlots + i);
 		}
+		m_GrowthLeft = MaxLoad(m_Capacity) - m_Size;
 
-		m_Alloc->Deallocate(m_Buckets);
+		if (oldCapacity)
+		{
+			m_Alloc->Deallocate(oldCtrl);
+		}
 	}
 
-	V& operator[](const K& key)
+	/// Allocate an empty table, without touching the old one.
+	void Allocate(u64 capacity)
 	{
-		FindResult res = FindBucket(key);
+		auto memory = reinterpret_cast<u8*>(m_Alloc->Allocate(SlotOffset(capacity) + capacity * sizeof(T), Alignment));
+		m_Ctrl = memory;
+		m_Slots = reinterpret_cast<T*>(memory + SlotOffset(capacity));
+		m_Capacity = capacity;
+		MemSet(m_Ctrl, CtrlEmpty, capacity);
+	}
 
-		if (res.Normal && res.Normal->Status == Bucket::Full)
+	/// Destroy every slot and free the table.
+	void Free()
+	{
+		if (!m_Capacity)
 		{
-			return res.Normal->Slot.Second;
+			return;
 		}
 
-		if (float(m_Size) / m_Capacity > 0.6f)
+		Clear();
+		m_Alloc->Deallocate(m_Ctrl);
+		m_Ctrl = const_cast<u8*>(EmptyGroup);
+		m_Slots = nullptr;
+		m_Capacity = 0;
+		m_GrowthLeft = 0;
+	}
+
+	void CopyFrom(const HashTable& other)
+	{
+		if (!other.m_Capacity)
 		{
-			Realloc();
-			res = FindBucket(key);
+			return;
 		}
 
-		auto bucket = res.Tombstone ? res.Tombstone : res.Normal;
+		Allocate(other.m_Capacity);
+		MemCopy(m_Ctrl, other.m_Ctrl, m_Capacity);
+		for (u64 i = 0; i < m_Capacity; i++)
+		{
+			if (!(m_Ctrl[i] & 0x80))
+			{
+				Construct<T>(m_Slots + i, other.m_Slots[i]);
+			}
+		}
+		m_Size = other.m_Size;
+		m_GrowthLeft = other.m_GrowthLeft;
+	}
 
-		Construct<Pair<K, V>>(&bucket->Slot, key, V());
-		bucket->Status = Bucket::Full;
-		m_Size++;
-		return bucket->Slot.Second;
+	void TakeFrom(HashTable& other)
+	{
+		m_Ctrl = other.m_Ctrl;
+		m_Slots = other.m_Slots;
+		m_Size = other.m_Size;
+		m_Capacity = other.m_Capacity;
+		m_GrowthLeft = other.m_GrowthLeft;
+
+		other.m_Ctrl = const_cast<u8*>(EmptyGroup);
+		other.m_Slots = nullptr;
+		other.m_Size = 0;
+		other.m_Capacity = 0;
+		other.m_GrowthLeft = 0;
 	}
 
-	/// Insert a key-value pair into the HashMap.
-	/// If the key already exists, its value is overwritten.
+	/// Index of the first full slot, or m_Capacity if there is none.
+	u64 FirstFull() const
+	{
+		u64 index = 0;
+		while (index < m_Capacity && (m_Ctrl[index] & 0x80))
+		{
+			index++;
+		}
+
+		return index;
+	}
+
+	Allocator* m_Alloc = nullptr;
+
+	/// Control byte of every slot. Points to EmptyGroup, which is never written to, while m_Capacity is 0.
+	u8* m_Ctrl = const_cast<u8*>(EmptyGroup);
+	T* m_Slots = nullptr;
+
+	u64 m_Size = 0;
+	u64 m_Capacity = 0;
+
+	/// Number of empty slots that can be filled before the table must grow.
+	u64 m_GrowthLeft = 0;
+};
+
+}
+
+/// Open-addressed HashMap, laid out as a Swiss table. See Private::HashTable for the layout.
+/// Entries are stored as Pairs, apart from the control bytes.
+///
+/// \tparam K Key type.
+/// \tparam V Value type.
+template<HashKey K, typename V>
+class HashMap
+{
+public:
+	using Iterator = Private::HashTableIterator<Pair<K, V>>;
+	using ConstIterator = Private::HashTableIterator<const Pair<K, V>>;
+
+	/// Constructor. Does not allocate until the first entry is inserted.
 	///
-	/// \param key The key.
-	/// \param value The value to store at the key.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	HashMap(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Table(alloc) {}
+
+	/// Construct a HashMap from a list of key-value pairs, allocating once for all of them.
+	/// Later pairs overwrite earlier ones with the same key.
 	///
-	/// \return Reference to the key-value pair stored.
-	Pair<K, V>& Insert(const K& key, const V& value)
+	/// \param list Pairs to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	HashMap(const std::initializer_list<Pair<K, V>>& list,
+		Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Table(alloc)
 	{
-		FindResult res = FindBucket(key);
-
-		if (res.Normal && res.Normal->Status == Bucket::Full)
+		Reserve(list.size());
+		for (auto& pair : list)
 		{
-			res.Normal->Slot.Second = value;
-			return res.Normal->Slot;
+			Insert(pair.First, pair.Second);
 		}
+	}
 
-		if (float(m_Size) / m_Capacity > 0.6f)
+	/// Construct a HashMap from key-value pairs, allocating once for all of them.
+	/// Later pairs overwrite earlier ones with the same key.
+	///
+	/// \param pairs Pairs to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	HashMap(ArrayRef<Pair<K, V>> pairs, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Table(alloc)
+	{
+		Reserve(pairs.Size());
+		for (auto& pair : pairs)
 		{
-			Realloc();
-			res = FindBucket(key);
+			Insert(pair.First, pair.Second);
 		}
+	}
 
-		auto bucket = res.Tombstone ? res.Tombstone : res.Normal;
+	/// Hash a key the way the HashMap does, for the overloads taking a precomputed hash.
+	/// The hash only depends on the key, so it can be reused across HashMaps with the same key type.
+	///
+	/// \param key The key.
+	///
+	/// \return The hash.
+	template<HashLookup<K> Q>
+	static u64 GetHash(const Q& key)
+	{
+		return Hasher<K>::Hash(key);
+	}
 
-		Construct<Pair<K, V>>(&bucket->Slot, key, value);
-		bucket->Status = Bucket::Full;
-		m_Size++;
-		return bucket->Slot;
+	/// Get the value stored at a key, default constructing it if the key doesn't exist.
+	///
+	/// \param key The key.
+	///
+	/// \return Reference to the value.
+	V& operator[](const K& key)
+	{
+		u64 hash = GetHash(key);
+		u64 index = m_Table.Find(key, hash);
+		if (index == Table::NotFound)
+		{
+			index = m_Table.PrepareInsert(hash);
+			Construct<Pair<K, V>>(&m_Table[index], key, V());
+		}
+
+		return m_Table[index].Second;
 	}
 
+	/// Insert a key-value pair into the HashMap.
+	/// If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	///
+	/// \return Reference to the key-value pair stored.
+	Pair<K, V>& Insert(const K& key, const V& value) { return InsertHashed(key, value, GetHash(key)); }
+
 	/// Insert a key-value pair into the HashMap.
 	/// If the key already exists, its value is overwritten.
 	///
@@ -299,26 +773,36 @@ public:
 	/// \return Reference to the key-value pair stored.
 	Pair<K, V>& Insert(K&& key, V&& value)
 	{
-		FindResult res = FindBucket(key);
-
-		if (res.Normal && res.Normal->Status == Bucket::Full)
-		{
-			res.Normal->Slot.Second = value;
-			return res.Normal->Slot;
-		}
-
-		if (float(m_Size) / m_Capacity > 0.6f)
-		{
-			Realloc();
-			res = FindBucket(key);
-		}
+		u64 hash = GetHash(key);
+		return InsertHashed(static_cast<K&&>(key), static_cast<V&&>(value), hash);
+	}
 
-		auto bucket = res.Tombstone ? res.Tombstone : res.Normal;
+	/// Insert a key-value pair into the HashMap, with the hash of the key already computed.
+	/// If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	/// \param hash Hash of the key, from GetHash().
+	///
+	/// \return Reference to the key-value pair stored.
+	Pair<K, V>& Insert(const K& key, const V& value, u64 hash)
+	{
+		IASSERT(hash == GetHash(key), "Precomputed hash does not match the key");
+		return InsertHashed(key, value, hash);
+	}
 
-		Construct<Pair<K, V>>(&bucket->Slot, key, value);
-		bucket->Status = Bucket::Full;
-		m_Size++;
-		return bucket->Slot;
+	/// Insert a key-value pair into the HashMap, with the hash of the key already computed.
+	/// If the key already exists, its value is overwritten.
+	///
+	/// \param key The key.
+	/// \param value The value to store at the key.
+	/// \param hash Hash of the key, from GetHash().
+	///
+	/// \return Reference to the key-value pair stored.
+	Pair<K, V>& Insert(K&& key, V&& value, u64 hash)
+	{
+		IASSERT(hash == GetHash(key), "Precomputed hash does not match the key");
+		return InsertHashed(static_cast<K&&>(key), static_cast<V&&>(value), hash);
 	}
 
 	/// Get the value stored at a key.
@@ -326,176 +810,159 @@ public:
 	/// \param key Key to search for.
 	///
 	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
-	V* Get(const K& key)
-	{
-		FindResult res = FindBucket(key);
+	V* Get(const K& key) { return Get(key, GetHash(key)); }
 
-		if (res.Normal && res.Normal->Status == Bucket::Full)
-		{
-			return &res.Normal->Slot.Second;
-		}
+	/// Get the value stored at a key.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	const V* Get(const K& key) const { return Get(key, GetHash(key)); }
 
-		return nullptr;
+	/// Get the value stored at a key, without converting the key to K.
+	/// Only for types the Hasher of K is transparent to, such as StringRef for String keys.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	template<HashLookup<K> Q>
+	V* Get(const Q& key)
+	{
+		return Get(key, GetHash(key));
 	}
 
-	/// Get the value stored at a key.
+	/// Get the value stored at a key, without converting the key to K.
+	/// Only for types the Hasher of K is transparent to, such as StringRef for String keys.
 	///
 	/// \param key Key to search for.
 	///
 	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
-	const V* Get(const K& key) const
+	template<HashLookup<K> Q>
+	const V* Get(const Q& key) const
 	{
-		FindResult res = FindBucket(key);
+		return Get(key, GetHash(key));
+	}
 
-		if (res.Normal && res.Normal->Status == Bucket::Full)
-		{
-			return &res.Normal->Slot.Second;
-		}
+	/// Get the value stored at a key, with the hash of the key already computed.
+	///
+	/// \param key Key to search for.
+	/// \param hash Hash of the key, from GetHash().
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	template<HashLookup<K> Q>
+	V* Get(const Q& key, u64 hash)
+	{
+		IASSERT(hash == GetHash(key), "Precomputed hash does not match the key");
+		u64 index = m_Table.Find(key, hash);
+		return index == Table::NotFound ? nullptr : &m_Table[index].Second;
+	}
 
-		return nullptr;
+	/// Get the value stored at a key, with the hash of the key already computed.
+	///
+	/// \param key Key to search for.
+	/// \param hash Hash of the key, from GetHash().
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	template<HashLookup<K> Q>
+	const V* Get(const Q& key, u64 hash) const
+	{
+		IASSERT(hash == GetHash(key), "Precomputed hash does not match the key");
+		u64 index = m_Table.Find(key, hash);
+		return index == Table::NotFound ? nullptr : &m_Table[index].Second;
 	}
 
 	/// Remove an entry from the HashMap.
 	///
 	/// \param key Entry to remove.
-	void Remove(const K& key)
-	{
-		FindResult res = FindBucket(key);
+	void Remove(const K& key) { Remove<K>(key); }
 
-		if (res.Normal && res.Normal->Status == Bucket::Full)
+	/// Remove an entry from the HashMap, without converting the key to K.
+	///
+	/// \param key Entry to remove.
+	template<HashLookup<K> Q>
+	void Remove(const Q& key)
+	{
+		u64 index = m_Table.Find(key, GetHash(key));
+		if (index != Table::NotFound)
 		{
-			res.Normal->Slot.~Pair<K, V>();
-			res.Normal->Status = Bucket::Tombstone;
-			m_Size--;
+			m_Table.Erase(index);
 		}
 	}
 
+	/// Make sure entries can be inserted without the HashMap growing.
+	///
+	/// \param count Number of entries to make space for, including the ones already in the HashMap.
+	void Reserve(u64 count) { m_Table.Reserve(count); }
+
+	/// Shrink the HashMap to the smallest capacity that fits its entries, freeing the allocation if it is empty.
+	/// Also clears out slots left behind by removed entries.
+	void ShrinkToFit() { m_Table.ShrinkToFit(); }
+
+	/// Clear out slots left behind by removed entries, without reallocating. Lookups for keys that don't exist have
+	/// to probe past these slots, so this speeds them up after lots of removals.
+	/// Happens on its own when inserting into a table that has run out of empty slots.
+	void Purge() { m_Table.Purge(); }
+
+	/// Remove every entry. Keeps the allocation around.
+	void Clear() { m_Table.Clear(); }
+
 	/// Get the number of entries in the HashMap.
 	///
 	/// \return The number of entries.
-	u64 Size() { return m_Size; }
+	u64 Size() const { return m_Table.Size(); }
 
 	/// Get the capacity of the HashMap before a reallocation is done.
 	///
 	/// \return The number of entries that can be stored until a reallocation must be done.
-	u64 Capacity() { return m_Capacity; }
+	u64 Capacity() const { return m_Table.Capacity(); }
 
 	/// Iteration.
 	///
 	/// \return Begin Iterator.
-	Iterator begin()
-	{
-		auto bucket = m_Buckets;
-		while (true)
-		{
-			if (bucket->Status == Bucket::Full)
-			{
-				return Iterator(bucket, m_Buckets + m_Capacity);
-			}
-			bucket++;
-		}
-	}
+	Iterator begin() { return m_Table.begin(); }
 
 	/// Iteration.
 	///
 	/// \return Begin Iterator.
-	ConstIterator begin() const
-	{
-		auto bucket = m_Buckets;
-		while (true)
-		{
-			if (bucket->Status == Bucket::Full)
-			{
-				return ConstIterator(bucket, m_Buckets + m_Capacity);
-			}
-			bucket++;
-		}
-	}
+	ConstIterator begin() const { return m_Table.begin(); }
 
 	/// Iteration.
 	///
 	/// \return End Iterator.
-	Iterator end() { return Iterator(m_Buckets + m_Capacity, m_Buckets + m_Capacity); }
+	Iterator end() { return m_Table.end(); }
 
 	/// Iteration.
 	///
 	/// \return End Iterator.
-	ConstIterator end() const { return ConstIterator(m_Buckets + m_Capacity, m_Buckets + m_Capacity); }
+	ConstIterator end() const { return m_Table.end(); }
 
 private:
-	struct FindResult
-	{
-		Bucket* Normal = nullptr;
-		Bucket* Tombstone = nullptr;
-	};
+	using Table = Private::HashTable<K, Pair<K, V>>;
 
-	FindResult FindBucket(const K& key) const
+	template<typename KF, typename VF>
+	Pair<K, V>& InsertHashed(KF&& key, VF&& value, u64 hash)
 	{
-		u64 hash = Hasher<K>::Hash(key);
-		u64 probe = hash & m_Mask;
-		u64 i = 1;
-		FindResult result;
-
-		while (i < m_Capacity)
+		u64 index = m_Table.Find(key, hash);
+		if (index != Table::NotFound)
 		{
-			if (m_Buckets[probe].Status == Bucket::Full && m_Buckets[probe].Slot.First == key)
-			{
-				result.Normal = m_Buckets + probe;
-				return result;
-			}
-			else if (m_Buckets[probe].Status == Bucket::Empty)
-			{
-				result.Normal = m_Buckets + probe;
-				return result;
-			}
-			else if (m_Buckets[probe].Status == Bucket::Tombstone)
-			{
-				result.Tombstone = m_Buckets + probe;
-			}
-
-			probe = (hash + i * i) & m_Mask;
-			i++;
-		}
-		return result;
-	}
-
-	void Realloc()
-	{
-		u64 oldCapacity = m_Capacity;
-		m_Capacity *= 2;
-		m_Mask = m_Capacity - 1;
-
-		auto old = m_Buckets;
-		m_Buckets = reinterpret_cast<Bucket*>(m_Alloc->Allocate(sizeof(Bucket) * m_Capacity));
-		m_Size = 0;
-		for (u64 i = 0; i < m_Capacity; i++)
-		{
-			m_Buckets[i].Status = Bucket::Empty;
+			m_Table[index].Second = static_cast<VF&&>(value);
+			return m_Table[index];
 		}
 
-		for (u64 i = 0; i < oldCapacity; i++)
-		{
-			if (old[i].Status == Bucket::Full)
-			{
-				Insert(Move(old[i].Slot.First), Move(old[i].Slot.Second));
-			}
-		}
-
-		m_Alloc->Deallocate(old);
+		index = m_Table.PrepareInsert(hash);
+		return *Construct<Pair<K, V>>(&m_Table[index], static_cast<KF&&>(key), static_cast<VF&&>(value));
 	}
 
-	Allocator* m_Alloc = nullptr;
-	Bucket* m_Buckets = nullptr;
-
-	u64 m_Size = 0;
-	u64 m_Capacity = 0;
-	u64 m_Mask = 0;
+	Table m_Table;
 };
 
-template<>
-struct Hasher<u64>
+namespace Traits {
+
+template<typename K, typename V>
+struct IsTriviallyRelocatable<HashMap<K, V>> : std::true_type
 {
-	static u64 Hash(u64 value) { return value; }
 };
 
 }
+
+}
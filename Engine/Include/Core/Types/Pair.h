@@ -18,6 +18,9 @@ struct Pair
 
 	/// Second element of the pair.
 	S Second;
+
+	/// Pairs are equal if both of their elements are. Deleted if the elements can't be compared.
+	bool operator==(const Pair&) const = default;
 };
 
 }
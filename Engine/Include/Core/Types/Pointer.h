@@ -4,12 +4,42 @@
 
 #pragma once
 #include <atomic>
+#include <concepts>
 
-#include "Core/Memory/RawAllocator.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Misc/Assert.h"
+#include "Core/Types/Traits.h"
 
 namespace Ignis {
 
+namespace Private {
+
+/// If the first argument is an allocator, in which case it is for the object's memory and not its constructor.
+template<typename... Args>
+constexpr bool FirstIsAllocator = false;
+
+template<typename First, typename... Args>
+constexpr bool FirstIsAllocator<First, Args...> = std::derived_from<std::remove_cvref_t<First>, Allocator>;
+
+/// Control block at the start of every allocation made by MakeShared().
+struct SharedBlock
+{
+	SharedBlock(Allocator* alloc, u64 size) : Alloc(alloc), Size(size) {}
+
+	/// Number of SharedPtrs pointing to the object.
+	std::atomic<u64> Ref = 1;
+
+	/// Allocator the block and the object were allocated from.
+	Allocator* Alloc;
+
+	/// Size of the allocation, or 0 if it is overaligned and must be freed without a size.
+	u64 Size;
+};
+
+}
+
 /// Owning pointer with complete ownership.
+/// Remembers its allocator, so the object doesn't need a header like New<T>() gives it.
 ///
 /// \tparam T Type to point to.
 template<typename T>
@@ -18,19 +48,40 @@ class UniquePtr
 public:
 	UniquePtr() = default;
 
-	template<typename O>
-	UniquePtr(const UniquePtr<O>& other) = delete;
+	UniquePtr(const UniquePtr& other) = delete;
+
+	UniquePtr(UniquePtr&& other) : m_Ptr(other.m_Ptr), m_Alloc(other.m_Alloc), m_Size(other.m_Size)
+	{
+		other.m_Ptr = nullptr;
+	}
 
 	/// Implicit conversion between automatically convertible types.
+	/// The conversion must not change the address, as the pointer is freed as it is.
 	template<typename O>
-	UniquePtr(UniquePtr<O>&& other)
+	UniquePtr(UniquePtr<O>&& other) : m_Ptr(other.m_Ptr), m_Alloc(other.m_Alloc), m_Size(other.m_Size)
 	{
-		m_Ptr = other.m_Ptr;
+		IASSERT(static_cast<void*>(m_Ptr) == static_cast<void*>(other.m_Ptr), "UniquePtr conversion changes the address");
 		other.m_Ptr = nullptr;
 	}
 
 	/// Destructor
-	~UniquePtr() { Delete(m_Ptr); }
+	~UniquePtr() { Free(); }
+
+	UniquePtr& operator=(const UniquePtr& other) = delete;
+
+	UniquePtr& operator=(UniquePtr&& other)
+	{
+		if (this != &other)
+		{
+			Free();
+			m_Ptr = other.m_Ptr;
+			m_Alloc = other.m_Alloc;
+			m_Size = other.m_Size;
+			other.m_Ptr = nullptr;
+		}
+
+		return *this;
+	}
 
 	/// Dereference the pointer.
 	///
@@ -49,65 +100,123 @@ public:
 
 private:
 	template<typename O, typename... Args>
-	friend UniquePtr<O> MakeUnique(Args&&... args, Allocator& alloc);
+	friend UniquePtr<O> MakeUnique(Allocator& alloc, Args&&... args);
 
 	template<typename O>
 	friend class UniquePtr;
 
-	UniquePtr(T* set) { m_Ptr = set; }
+	UniquePtr(T* ptr, Allocator* alloc, u64 size) : m_Ptr(ptr), m_Alloc(alloc), m_Size(size) {}
+
+	void Free()
+	{
+		if (m_Ptr)
+		{
+			m_Ptr->~T();
+			if (m_Size)
+			{
+				m_Alloc->Deallocate(m_Ptr, m_Size);
+			}
+			else
+			{
+				m_Alloc->Deallocate(m_Ptr);
+			}
+			m_Ptr = nullptr;
+		}
+	}
 
 	T* m_Ptr = nullptr;
+	Allocator* m_Alloc = nullptr;
+
+	/// Size of the object it was created as, or 0 if it is overaligned and must be freed without a size.
+	u64 m_Size = 0;
 };
 
 /// Instantiate an object with single ownership.
 ///
 /// \tparam T Type of object to instantiate.
-/// \param args Arguments to pass to constructor.
 /// \param alloc Allocator to use for allocating the object.
+/// \param args Arguments to pass to constructor.
 ///
 /// \return Owning pointer to the created object.
 template<typename T, typename... Args>
-UniquePtr<T> MakeUnique(Args&&... args, Allocator& alloc = GAlloc)
+UniquePtr<T> MakeUnique(Allocator& alloc, Args&&... args)
 {
-	return UniquePtr<T>(New<T>(static_cast<Args&&>(args)..., alloc));
+	return UniquePtr<T>(Create<T>(alloc, static_cast<Args&&>(args)...), &alloc, alignof(T) > 16 ? 0 : sizeof(T));
+}
+
+/// Instantiate an object with single ownership, allocated from GAlloc.
+///
+/// \tparam T Type of object to instantiate.
+/// \param args Arguments to pass to constructor.
+///
+/// \return Owning pointer to the created object.
+template<typename T, typename... Args>
+requires(!Private::FirstIsAllocator<Args...>) UniquePtr<T> MakeUnique(Args&&... args)
+{
+	return MakeUnique<T>(GAlloc, static_cast<Args&&>(args)...);
 }
 
 /// Reference counted pointer.
+/// The reference count lives in the same allocation as the object.
+///
+/// \tparam T Type to point to.
 template<typename T>
 class SharedPtr
 {
 public:
 	SharedPtr() = default;
 
+	SharedPtr(const SharedPtr& other) : m_Ptr(other.m_Ptr), m_Block(other.m_Block) { Acquire(); }
+
 	/// Implicit conversion between automatically convertible types.
 	template<typename O>
-	SharedPtr(const SharedPtr<O>& other)
+	SharedPtr(const SharedPtr<O>& other) : m_Ptr(other.m_Ptr), m_Block(other.m_Block)
 	{
-		m_Ptr = other.m_Ptr;
-		m_Ref = other.m_Ref(*m_Ref)++;
+		Acquire();
+	}
+
+	SharedPtr(SharedPtr&& other) : m_Ptr(other.m_Ptr), m_Block(other.m_Block)
+	{
+		other.m_Ptr = nullptr;
+		other.m_Block = nullptr;
 	}
 
 	/// Implicit conversion between automatically convertible types.
 	template<typename O>
-	SharedPtr(SharedPtr<O>&& other)
+	SharedPtr(SharedPtr<O>&& other) : m_Ptr(other.m_Ptr), m_Block(other.m_Block)
 	{
-		m_Ptr = other.m_Ptr;
-		m_Ref = other.m_Ref;
 		other.m_Ptr = nullptr;
+		other.m_Block = nullptr;
 	}
 
 	/// Destructor
-	~SharedPtr()
+	~SharedPtr() { Release(); }
+
+	SharedPtr& operator=(const SharedPtr& other)
 	{
-		if (m_Ptr)
+		if (this != &other)
 		{
-			(*m_Ref)--;
-			if (!(*m_Ref)) // Destroy if refcount is 0.
-			{
-				Delete(m_Ptr);
-				Delete(m_Ref);
-			}
+			Release();
+			m_Ptr = other.m_Ptr;
+			m_Block = other.m_Block;
+			Acquire();
+		}
+
+		return *this;
+	}
+
+	SharedPtr& operator=(SharedPtr&& other)
+	{
+		if (this != &other)
+		{
+			Release();
+			m_Ptr = other.m_Ptr;
+			m_Block = other.m_Block;
+			other.m_Ptr = nullptr;
+			other.m_Block = nullptr;
 		}
+
+		return *this;
 	}
 
 	/// Dereference the pointer.
@@ -120,29 +229,82 @@ public:
 	/// \return Pointer to the object.
 	T* operator->() { return m_Ptr; }
 
+	/// Get the pointer held by the SharedPtr.
+	///
+	/// \return The pointer.
+	T* Get() { return m_Ptr; }
+
 private:
 	template<typename O, typename... Args>
-	friend SharedPtr<O> MakeShared(Args&&... args, Allocator& alloc);
+	friend SharedPtr<O> MakeShared(Allocator& alloc, Args&&... args);
+
+	template<typename O>
+	friend class SharedPtr;
+
+	SharedPtr(T* ptr, Private::SharedBlock* block) : m_Ptr(ptr), m_Block(block) {}
+
+	void Acquire()
+	{
+		if (m_Block)
+		{
+			m_Block->Ref.fetch_add(1, std::memory_order::relaxed);
+		}
+	}
+
+	void Release()
+	{
+		// Destroy if this was the last reference.
+		if (m_Block && m_Block->Ref.fetch_sub(1, std::memory_order::acq_rel) == 1)
+		{
+			m_Ptr->~T();
+			if (m_Block->Size)
+			{
+				m_Block->Alloc->Deallocate(m_Block, m_Block->Size);
+			}
+			else
+			{
+				m_Block->Alloc->Deallocate(m_Block);
+			}
+		}
 
-	SharedPtr(T* ptr, std::atomic<u64>* ref) : m_Ptr(ptr), m_Ref(ref) {}
+		m_Ptr = nullptr;
+		m_Block = nullptr;
+	}
 
-	T* m_Ptr;
-	std::atomic<u64>* m_Ref;
+	T* m_Ptr = nullptr;
+	Private::SharedBlock* m_Block = nullptr;
 };
 
 /// Instantiate an object with shared ownership.
+/// The object and its reference count are allocated together.
 ///
 /// \tparam T Type of object to instantiate.
-/// \param args Arguments to pass to constructor.
 /// \param alloc Allocator to use for allocating the object.
+/// \param args Arguments to pass to constructor.
 ///
 /// \return Owning pointer to the created object.
-template<typename O, typename... Args>
-SharedPtr<O> MakeShared(Args&&... args, Allocator& alloc)
+template<typename T, typename... Args>
+SharedPtr<T> MakeShared(Allocator& alloc, Args&&... args)
 {
-	auto ptr = New<O>(alloc, static_cast<Args&&>(args)...);
-	auto ref = New<std::atomic<u64>>(alloc, 1);
-	return SharedPtr<O>(ptr, ref);
+	constexpr u64 alignment = alignof(T) > alignof(Private::SharedBlock) ? alignof(T) : alignof(Private::SharedBlock);
+	constexpr u64 offset = (sizeof(Private::SharedBlock) + alignof(T) - 1) & ~(alignof(T) - 1);
+	constexpr u64 size = offset + sizeof(T);
+
+	void* ptr = alloc.Allocate(size, alignment);
+	auto block = Construct<Private::SharedBlock>(ptr, &alloc, alignment > 16 ? 0 : size);
+	return SharedPtr<T>(Construct<T>(reinterpret_cast<u8*>(ptr) + offset, static_cast<Args&&>(args)...), block);
+}
+
+/// Instantiate an object with shared ownership, allocated from GAlloc.
+///
+/// \tparam T Type of object to instantiate.
+/// \param args Arguments to pass to constructor.
+///
+/// \return Owning pointer to the created object.
+template<typename T, typename... Args>
+requires(!Private::FirstIsAllocator<Args...>) SharedPtr<T> MakeShared(Args&&... args)
+{
+	return MakeShared<T>(GAlloc, static_cast<Args&&>(args)...);
 }
 
 template<typename>
@@ -186,4 +348,18 @@ private:
 	u64 m_Index;
 };
 
+namespace Traits {
+
+template<typename T>
+struct IsTriviallyRelocatable<UniquePtr<T>> : std::true_type
+{
+};
+
+template<typename T>
+struct IsTriviallyRelocatable<SharedPtr<T>> : std::true_type
+{
+};
+
+}
+
 }
@@ -4,7 +4,9 @@
 
 #pragma once
 #include <atomic>
+#include <bit>
 
+#include "Core/Memory/MemoryTag.h"
 #include "Core/Memory/RawAllocator.h"
 
 namespace Ignis {
@@ -19,8 +21,8 @@ public:
 	/// Construct an MPMCQueue.
 	///
 	/// \param size The number of elements to hold in the queue.
-	/// \param alloc Allocator to use. Defaults to GAlloc.
-	MPMCQueue(u64 size, Allocator& alloc = GAlloc) : m_Alloc(&alloc)
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	MPMCQueue(u64 size, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Alloc(&alloc)
 	{
 		size--;
 		size |= size >> 1;
@@ -32,7 +34,7 @@ public:
 
 		m_Mask = size;
 		m_Capacity = size + 1;
-		m_Slots = reinterpret_cast<Slot<T>*>(m_Alloc->Allocate(sizeof(Slot<T>) * (m_Capacity + 1)));
+		m_Slots = reinterpret_cast<Slot<T>*>(m_Alloc->Allocate(sizeof(Slot<T>) * (m_Capacity + 1), alignof(Slot<T>)));
 		for (u64 i = 0; i < m_Capacity; i++)
 		{
 			Construct<Slot<T>>(&m_Slots[i]);
@@ -151,7 +153,7 @@ public:
 	/// \param obj Object to push.
 	///
 	/// \return If the push succeeded. If returns false, the queue was full.
-	bool TryPush(T&& obj) { return TryEmplace(Move(obj)); }
+	bool TryPush(T&& obj) { return TryEmplace(std::move(obj)); }
 
 	T Pop()
 	{
@@ -226,4 +228,360 @@ private:
 	alignas(64) std::atomic<u64> m_Tail = 0;
 };
 
+
+/// A single-producer, single-consumer, bounded, wait-free queue.
+/// Each side keeps a cached copy of the other side's index, and only reloads it when the queue looks full or empty,
+/// so the two threads only share cache lines when they catch up to each other.
+template<typename T>
+class SPSCQueue
+{
+public:
+	SPSCQueue() = default;
+
+	/// Construct an SPSCQueue.
+	///
+	/// \param size The number of elements to hold in the queue. Rounded up to a power of 2.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	SPSCQueue(u64 size, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Alloc(&alloc)
+	{
+		m_Mask = std::bit_ceil(size) - 1;
+		m_Data = reinterpret_cast<T*>(m_Alloc->Allocate(sizeof(T) * (m_Mask + 1), alignof(T)));
+	}
+
+	SPSCQueue(const SPSCQueue<T>& other) = delete;
+
+	/// Destructor.
+	~SPSCQueue()
+	{
+		if (!m_Data)
+		{
+			return;
+		}
+
+		for (u64 i = m_Tail.load(); i != m_Head.load(); i++)
+		{
+			m_Data[Index(i)].~T();
+		}
+
+		m_Alloc->Deallocate(m_Data);
+	}
+
+	/// Move assignment. Neither queue can be in use.
+	SPSCQueue<T>& operator=(SPSCQueue<T>&& other)
+	{
+		this->~SPSCQueue<T>();
+
+		m_Data = other.m_Data;
+		other.m_Data = nullptr;
+		m_Mask = other.m_Mask;
+		m_Alloc = other.m_Alloc;
+		m_Head = other.m_Head.load();
+		m_CachedTail = other.m_CachedTail;
+		m_Tail = other.m_Tail.load();
+		m_CachedHead = other.m_CachedHead;
+
+		return *this;
+	}
+
+	/// Try to emplace an object in the queue. Only call from the producer thread.
+	///
+	/// \param args Arguments to pass to the constructor.
+	///
+	/// \return If the emplace succeeded. If returns false, the queue is full.
+	template<typename... Args>
+	bool TryEmplace(Args&&... args)
+	{
+		u64 head = m_Head.load(std::memory_order::relaxed);
+		if (head - m_CachedTail > m_Mask)
+		{
+			m_CachedTail = m_Tail.load(std::memory_order::acquire);
+			if (head - m_CachedTail > m_Mask)
+			{
+				return false;
+			}
+		}
+
+		Construct<T>(&m_Data[Index(head)], static_cast<Args&&>(args)...);
+		m_Head.store(head + 1, std::memory_order::release);
+
+		return true;
+	}
+
+	/// Emplace an object on the end of the queue. Spinlocks if the queue is full. Only call from the producer thread.
+	///
+	/// \param args Arguments to pass to the constructor.
+	template<typename... Args>
+	void Emplace(Args&&... args)
+	{
+		while (!TryEmplace(static_cast<Args&&>(args)...)) {}
+	}
+
+	/// Push a copy of an object on the end of the queue. Spinlocks if the queue is full.
+	///
+	/// \param obj Object to push.
+	void Push(const T& obj) { Emplace(obj); }
+
+	/// Push an object on the end of the queue. Spinlocks if the queue is full.
+	///
+	/// \param obj Object to push.
+	void Push(T&& obj) { Emplace(std::move(obj)); }
+
+	/// Try to push a copy of an object onto the queue.
+	///
+	/// \param obj Object to push.
+	///
+	/// \return If the push succeeded. If returns false, the queue was full.
+	bool TryPush(const T& obj) { return TryEmplace(obj); }
+
+	/// Try to push an object onto the queue.
+	///
+	/// \param obj Object to push.
+	///
+	/// \return If the push succeeded. If returns false, the queue was full.
+	bool TryPush(T&& obj) { return TryEmplace(std::move(obj)); }
+
+	/// Try to pop an object from the front of the queue. Only call from the consumer thread.
+	///
+	/// \param obj Object to move the popped object into.
+	///
+	/// \return If the pop succeeded. If returns false, the queue was empty.
+	bool TryPop(T& obj)
+	{
+		u64 tail = m_Tail.load(std::memory_order::relaxed);
+		if (tail == m_CachedHead)
+		{
+			m_CachedHead = m_Head.load(std::memory_order::acquire);
+			if (tail == m_CachedHead)
+			{
+				return false;
+			}
+		}
+
+		T& slot = m_Data[Index(tail)];
+		obj = std::move(slot);
+		slot.~T();
+		m_Tail.store(tail + 1, std::memory_order::release);
+
+		return true;
+	}
+
+	/// Pop an object from the front of the queue. Spinlocks if the queue is empty. Only call from the consumer thread.
+	///
+	/// \return The popped object.
+	T Pop()
+	{
+		u64 tail = m_Tail.load(std::memory_order::relaxed);
+		while (tail == m_CachedHead)
+		{
+			m_CachedHead = m_Head.load(std::memory_order::acquire);
+		}
+
+		T& slot = m_Data[Index(tail)];
+		T temp = std::move(slot);
+		slot.~T();
+		m_Tail.store(tail + 1, std::memory_order::release);
+
+		return temp;
+	}
+
+private:
+	constexpr u64 Index(u64 i) { return i & m_Mask; }
+
+	T* m_Data = nullptr;
+	u64 m_Mask = 0;
+	Allocator* m_Alloc = nullptr;
+
+	alignas(64) std::atomic<u64> m_Head = 0;
+	u64 m_CachedTail = 0;
+
+	alignas(64) std::atomic<u64> m_Tail = 0;
+	u64 m_CachedHead = 0;
+};
+
+/// A multi-producer, single-consumer, bounded, lockless queue.
+/// Producers claim slots like MPMCQueue, but the consumer owns its index outright,
+/// so popping is wait-free and never touches the producers' cache line.
+template<typename T>
+class MPSCQueue
+{
+public:
+	MPSCQueue() = default;
+
+	/// Construct an MPSCQueue.
+	///
+	/// \param size The number of elements to hold in the queue. Rounded up to a power of 2.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	MPSCQueue(u64 size, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Alloc(&alloc)
+	{
+		m_Mask = std::bit_ceil(size) - 1;
+		m_Slots = reinterpret_cast<Slot*>(m_Alloc->Allocate(sizeof(Slot) * (m_Mask + 1), alignof(Slot)));
+		for (u64 i = 0; i <= m_Mask; i++)
+		{
+			Construct<std::atomic<u64>>(&m_Slots[i].Sequence, i);
+		}
+	}
+
+	MPSCQueue(const MPSCQueue<T>& other) = delete;
+
+	/// Destructor.
+	~MPSCQueue()
+	{
+		if (!m_Slots)
+		{
+			return;
+		}
+
+		for (u64 i = m_Tail; i != m_Head.load(); i++)
+		{
+			reinterpret_cast<T*>(m_Slots[Index(i)].Storage)->~T();
+		}
+
+		m_Alloc->Deallocate(m_Slots);
+	}
+
+	/// Move assignment. Neither queue can be in use.
+	MPSCQueue<T>& operator=(MPSCQueue<T>&& other)
+	{
+		this->~MPSCQueue<T>();
+
+		m_Slots = other.m_Slots;
+		other.m_Slots = nullptr;
+		m_Mask = other.m_Mask;
+		m_Alloc = other.m_Alloc;
+		m_Head = other.m_Head.load();
+		m_Tail = other.m_Tail;
+
+		return *this;
+	}
+
+	/// Emplace an object on the end of the queue. Spinlocks if the queue is full.
+	///
+	/// \param args Arguments to pass to the constructor.
+	template<typename... Args>
+	void Emplace(Args&&... args)
+	{
+		u64 head = m_Head.fetch_add(1, std::memory_order::relaxed);
+		Slot& slot = m_Slots[Index(head)];
+		while (slot.Sequence.load(std::memory_order::acquire) != head) {}
+
+		Construct<T>(slot.Storage, static_cast<Args&&>(args)...);
+		slot.Sequence.store(head + 1, std::memory_order::release);
+	}
+
+	/// Try to emplace an object in the queue.
+	///
+	/// \param args Arguments to pass to the constructor.
+	///
+	/// \return If the emplace succeeded. If returns false, the queue is full.
+	template<typename... Args>
+	bool TryEmplace(Args&&... args)
+	{
+		u64 head = m_Head.load(std::memory_order::relaxed);
+		while (true)
+		{
+			Slot& slot = m_Slots[Index(head)];
+			i64 diff = i64(slot.Sequence.load(std::memory_order::acquire) - head);
+			if (diff == 0)
+			{
+				if (m_Head.compare_exchange_weak(head, head + 1, std::memory_order::relaxed))
+				{
+					Construct<T>(slot.Storage, static_cast<Args&&>(args)...);
+					slot.Sequence.store(head + 1, std::memory_order::release);
+
+					return true;
+				}
+			}
+			else if (diff < 0) // The slot still holds an object from the last lap, the queue is full.
+			{
+				return false;
+			}
+			else // Another producer claimed the slot.
+			{
+				head = m_Head.load(std::memory_order::relaxed);
+			}
+		}
+	}
+
+	/// Push a copy of an object on the end of the queue. Spinlocks if the queue is full.
+	///
+	/// \param obj Object to push.
+	void Push(const T& obj) { Emplace(obj); }
+
+	/// Push an object on the end of the queue. Spinlocks if the queue is full.
+	///
+	/// \param obj Object to push.
+	void Push(T&& obj) { Emplace(std::move(obj)); }
+
+	/// Try to push a copy of an object onto the queue.
+	///
+	/// \param obj Object to push.
+	///
+	/// \return If the push succeeded. If returns false, the queue was full.
+	bool TryPush(const T& obj) { return TryEmplace(obj); }
+
+	/// Try to push an object onto the queue.
+	///
+	/// \param obj Object to push.
+	///
+	/// \return If the push succeeded. If returns false, the queue was full.
+	bool TryPush(T&& obj) { return TryEmplace(std::move(obj)); }
+
+	/// Try to pop an object from the front of the queue. Only call from the consumer thread.
+	/// Returns false if the next producer in line hasn't finished writing, even if later ones have.
+	///
+	/// \param obj Object to move the popped object into.
+	///
+	/// \return If the pop succeeded. If returns false, the queue was empty.
+	bool TryPop(T& obj)
+	{
+		Slot& slot = m_Slots[Index(m_Tail)];
+		if (slot.Sequence.load(std::memory_order::acquire) != m_Tail + 1)
+		{
+			return false;
+		}
+
+		T* ptr = reinterpret_cast<T*>(slot.Storage);
+		obj = std::move(*ptr);
+		ptr->~T();
+		slot.Sequence.store(m_Tail + m_Mask + 1, std::memory_order::release);
+		m_Tail++;
+
+		return true;
+	}
+
+	/// Pop an object from the front of the queue. Spinlocks if the queue is empty. Only call from the consumer thread.
+	///
+	/// \return The popped object.
+	T Pop()
+	{
+		Slot& slot = m_Slots[Index(m_Tail)];
+		while (slot.Sequence.load(std::memory_order::acquire) != m_Tail + 1) {}
+
+		T* ptr = reinterpret_cast<T*>(slot.Storage);
+		T temp = std::move(*ptr);
+		ptr->~T();
+		slot.Sequence.store(m_Tail + m_Mask + 1, std::memory_order::release);
+		m_Tail++;
+
+		return temp;
+	}
+
+private:
+	struct Slot
+	{
+		/// Equal to the index a producer must have claimed to write the slot, plus one once it is written.
+		std::atomic<u64> Sequence;
+		alignas(T) u8 Storage[sizeof(T)];
+	};
+
+	constexpr u64 Index(u64 i) { return i & m_Mask; }
+
+	Slot* m_Slots = nullptr;
+	u64 m_Mask = 0;
+	Allocator* m_Alloc = nullptr;
+
+	alignas(64) std::atomic<u64> m_Head = 0;
+	alignas(64) u64 m_Tail = 0;
+};
+
 }
@@ -0,0 +1,179 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Sets of unique keys.
+
+#pragma once
+#include "Core/Types/Map.h"
+
+namespace Ignis {
+
+/// Open-addressed HashSet, laid out as a Swiss table like HashMap. See Private::HashTable for the layout.
+///
+/// \tparam K Key type.
+template<HashKey K>
+class HashSet
+{
+public:
+	using Iterator = Private::HashTableIterator<const K>;
+	using ConstIterator = Private::HashTableIterator<const K>;
+
+	/// Constructor. Does not allocate until the first key is inserted.
+	///
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	HashSet(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Table(alloc) {}
+
+	/// Construct a HashSet from a list of keys, allocating once for all of them.
+	///
+	/// \param list Keys to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	HashSet(const std::initializer_list<K>& list,
+		Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers))
+		: m_Table(alloc)
+	{
+		Reserve(list.size());
+		for (auto& key : list)
+		{
+			Insert(key);
+		}
+	}
+
+	/// Construct a HashSet from keys, allocating once for all of them.
+	///
+	/// \param keys Keys to insert.
+	/// \param alloc Allocator to use. Defaults to the allocator of MemoryTag::Containers.
+	HashSet(ArrayRef<K> keys, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Containers)) : m_Table(alloc)
+	{
+		Reserve(keys.Size());
+		for (auto& key : keys)
+		{
+			Insert(key);
+		}
+	}
+
+	/// Insert a key into the HashSet.
+	///
+	/// \param key The key.
+	///
+	/// \return If the key was inserted, and wasn't in the HashSet already.
+	bool Insert(const K& key)
+	{
+		u64 hash = Hasher<K>::Hash(key);
+		if (m_Table.Find(key, hash) != Table::NotFound)
+		{
+			return false;
+		}
+
+		Construct<K>(&m_Table[m_Table.PrepareInsert(hash)], key);
+		return true;
+	}
+
+	/// Insert a key into the HashSet.
+	///
+	/// \param key The key.
+	///
+	/// \return If the key was inserted, and wasn't in the HashSet already.
+	bool Insert(K&& key)
+	{
+		u64 hash = Hasher<K>::Hash(key);
+		if (m_Table.Find(key, hash) != Table::NotFound)
+		{
+			return false;
+		}
+
+		Construct<K>(&m_Table[m_Table.PrepareInsert(hash)], static_cast<K&&>(key));
+		return true;
+	}
+
+	/// Check if a key is in the HashSet.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return If the key is in the HashSet.
+	bool Contains(const K& key) const { return Contains<K>(key); }
+
+	/// Check if a key is in the HashSet, without converting the key to K.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return If the key is in the HashSet.
+	template<HashLookup<K> Q>
+	bool Contains(const Q& key) const
+	{
+		return m_Table.Find(key, Hasher<K>::Hash(key)) != Table::NotFound;
+	}
+
+	/// Remove a key from the HashSet.
+	///
+	/// \param key Key to remove.
+	///
+	/// \return If the key was in the HashSet.
+	bool Remove(const K& key) { return Remove<K>(key); }
+
+	/// Remove a key from the HashSet, without converting the key to K.
+	///
+	/// \param key Key to remove.
+	///
+	/// \return If the key was in the HashSet.
+	template<HashLookup<K> Q>
+	bool Remove(const Q& key)
+	{
+		u64 index = m_Table.Find(key, Hasher<K>::Hash(key));
+		if (index == Table::NotFound)
+		{
+			return false;
+		}
+
+		m_Table.Erase(index);
+		return true;
+	}
+
+	/// Make sure keys can be inserted without the HashSet growing.
+	///
+	/// \param count Number of keys to make space for, including the ones already in the HashSet.
+	void Reserve(u64 count) { m_Table.Reserve(count); }
+
+	/// Shrink the HashSet to the smallest capacity that fits its keys, freeing the allocation if it is empty.
+	void ShrinkToFit() { m_Table.ShrinkToFit(); }
+
+	/// Clear out slots left behind by removed keys, without reallocating.
+	void Purge() { m_Table.Purge(); }
+
+	/// Remove every key. Keeps the allocation around.
+	void Clear() { m_Table.Clear(); }
+
+	/// Get the number of keys in the HashSet.
+	///
+	/// \return The number of keys.
+	u64 Size() const { return m_Table.Size(); }
+
+	/// Get the capacity of the HashSet before a reallocation is done.
+	///
+	/// \return The number of keys that can be stored until a reallocation must be done.
+	u64 Capacity() const { return m_Table.Capacity(); }
+
+	/// Iteration. Keys can't be changed in place, as that would change their hash.
+	///
+	/// \return Begin Iterator.
+	ConstIterator begin() const { return m_Table.begin(); }
+
+	/// Iteration.
+	///
+	/// \return End Iterator.
+	ConstIterator end() const { return m_Table.end(); }
+
+private:
+	using Table = Private::HashTable<K, K>;
+
+	Table m_Table;
+};
+
+namespace Traits {
+
+template<typename K>
+struct IsTriviallyRelocatable<HashSet<K>> : std::true_type
+{
+};
+
+}
+
+}
@@ -0,0 +1,268 @@
+/// Copyright (c) 2021 Shaye Garg.
+/// \file
+/// Perfect hash maps for keys known at compile time.
+
+#pragma once
+#include <bit>
+
+#include "Core/Types/Hash.h"
+#include "Core/Types/Pair.h"
+#include "Core/Types/String.h"
+
+namespace Ignis {
+
+/// Hashes keys for StaticMaps. Specialize it with a constexpr static Hash function taking a key and a seed, and
+/// returning a u64. Unlike Hasher, the hash must change completely with the seed, as the StaticMap is built by trying
+/// seeds until no two keys have the same hash.
+template<typename>
+struct StaticHasher;
+
+/// StaticHasher for integers and enums.
+template<typename T>
+requires std::is_integral_v<T> || std::is_enum_v<T>
+struct StaticHasher<T>
+{
+	static constexpr u64 Hash(T value, u64 seed) { return CombineHash(seed, u64(value)); }
+};
+
+/// StaticHasher for strings. Reads 8 bytes at a time, which compilers turn into a single load outside of constant
+/// expressions.
+template<>
+struct StaticHasher<StringRef>
+{
+	static constexpr u64 Hash(StringRef value, u64 seed)
+	{
+		const char* data = value.m_Data;
+		u64 size = value.m_Size;
+		u64 hash = CombineHash(seed, size);
+		u64 i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			hash = Private::MulFold(hash ^ Read(data + i, 8), 0x8BB84B93962EACC9);
+		}
+
+		return CombineHash(hash, Read(data + i, size - i));
+	}
+
+private:
+	static constexpr u64 Read(const char* data, u64 size)
+	{
+		u64 value = 0;
+		for (u64 i = 0; i < size; i++)
+		{
+			value |= u64(u8(data[i])) << (i * 8);
+		}
+
+		return value;
+	}
+};
+
+namespace Private {
+
+/// Not defined: calling it while building a StaticMap stops compilation, with the reason in the error.
+void InvalidStaticMap(const char* reason);
+
+}
+
+/// Read-only map built at compile time with a perfect hash, for key sets known ahead of time,
+/// like names of enum values or config keys. Build it with MakeStaticMap().
+///
+/// The high bits of a key's hash pick a bucket, and the low bits, XORed with a displacement stored for the bucket,
+/// pick the slot. The seed of the hash and the displacements are picked so that every key lands in its own slot,
+/// so a lookup is a hash, two loads and a single key comparison, with no probing and no branches.
+///
+/// \tparam K Key type. Must have a StaticHasher.
+/// \tparam V Value type.
+/// \tparam N Number of entries.
+template<typename K, typename V, u64 N>
+requires(N > 0)
+class StaticMap
+{
+public:
+	/// Build the map. Only usable in constant expressions, so there is no cost at runtime.
+	/// Fails to compile if keys are repeated.
+	///
+	/// \param entries Key-value pairs.
+	consteval StaticMap(const Pair<K, V> (&entries)[N])
+	{
+		for (u64 i = 0; i < N; i++)
+		{
+			for (u64 j = i + 1; j < N; j++)
+			{
+				if (entries[i].First == entries[j].First)
+				{
+					Private::InvalidStaticMap("Keys of a StaticMap must be unique");
+				}
+			}
+		}
+
+		for (m_Seed = 0; m_Seed < MaxSeeds; m_Seed++)
+		{
+			if (TryBuild(entries))
+			{
+				return;
+			}
+		}
+
+		Private::InvalidStaticMap("Could not find a perfect hash for the keys of a StaticMap");
+	}
+
+	/// Get the value stored at a key.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return Pointer to the value. Is nullptr if the key doesn't exist.
+	constexpr const V* Get(const K& key) const
+	{
+		const Pair<K, V>& entry = m_Entries[SlotOf(StaticHasher<K>::Hash(key, m_Seed))];
+		return entry.First == key ? &entry.Second : nullptr;
+	}
+
+	/// Get the value stored at a key, or a fallback if the key doesn't exist.
+	///
+	/// \param key Key to search for.
+	/// \param fallback Value to return if the key doesn't exist.
+	///
+	/// \return The value.
+	constexpr V GetOr(const K& key, const V& fallback) const
+	{
+		const Pair<K, V>& entry = m_Entries[SlotOf(StaticHasher<K>::Hash(key, m_Seed))];
+		return entry.First == key ? entry.Second : fallback;
+	}
+
+	/// Check if a key is in the map.
+	///
+	/// \param key Key to search for.
+	///
+	/// \return If the key is in the map.
+	constexpr bool Contains(const K& key) const
+	{
+		return m_Entries[SlotOf(StaticHasher<K>::Hash(key, m_Seed))].First == key;
+	}
+
+	/// Get the number of entries in the map.
+	///
+	/// \return The number of entries.
+	constexpr u64 Size() const { return N; }
+
+private:
+	static constexpr u64 MaxSeeds = 1024;
+
+	/// Number of slots and buckets, a power of 2 so they can be picked with a mask.
+	static constexpr u64 Slots = std::bit_ceil(N);
+	static constexpr u64 BucketShift = 64 - std::countr_zero(Slots);
+
+	static constexpr u64 BucketOf(u64 hash) { return Slots == 1 ? 0 : hash >> BucketShift; }
+
+	constexpr u64 SlotOf(u64 hash) const { return (hash ^ m_Displacements[BucketOf(hash)]) & (Slots - 1); }
+
+	consteval bool TryBuild(const Pair<K, V> (&entries)[N])
+	{
+		// Sort the keys by bucket, so the keys of a bucket are next to each other.
+		u64 hashes[N] = {};
+		u64 starts[Slots + 1] = {};
+		for (u64 i = 0; i < N; i++)
+		{
+			hashes[i] = StaticHasher<K>::Hash(entries[i].First, m_Seed);
+			starts[BucketOf(hashes[i]) + 1]++;
+		}
+
+		u64 largest = 0;
+		for (u64 bucket = 0; bucket < Slots; bucket++)
+		{
+			largest = starts[bucket + 1] > largest ? starts[bucket + 1] : largest;
+			starts[bucket + 1] += starts[bucket];
+		}
+
+		u64 keys[N] = {};
+		u64 filled[Slots] = {};
+		for (u64 i = 0; i < N; i++)
+		{
+			u64 bucket = BucketOf(hashes[i]);
+			keys[starts[bucket] + filled[bucket]++] = i;
+		}
+
+		// Keys in the same bucket are displaced together, so they must differ in the low bits.
+		for (u64 bucket = 0; bucket < Slots; bucket++)
+		{
+			for (u64 i = starts[bucket]; i < starts[bucket + 1]; i++)
+			{
+				for (u64 j = i + 1; j < starts[bucket + 1]; j++)
+				{
+					if (((hashes[keys[i]] ^ hashes[keys[j]]) & (Slots - 1)) == 0)
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		// Place the largest buckets first, while most slots are still free.
+		u64 placed[Slots] = {};
+		bool taken[Slots] = {};
+		for (u64 size = largest; size > 0; size--)
+		{
+			for (u64 bucket = 0; bucket < Slots; bucket++)
+			{
+				if (starts[bucket + 1] - starts[bucket] != size)
+				{
+					continue;
+				}
+
+				u64 displacement = 0;
+				for (; displacement < Slots; displacement++)
+				{
+					bool fits = true;
+					for (u64 i = starts[bucket]; i < starts[bucket + 1] && fits; i++)
+					{
+						fits = !taken[(hashes[keys[i]] ^ displacement) & (Slots - 1)];
+					}
+
+					if (fits)
+					{
+						break;
+					}
+				}
+
+				if (displacement == Slots)
+				{
+					return false;
+				}
+
+				m_Displacements[bucket] = displacement;
+				for (u64 i = starts[bucket]; i < starts[bucket + 1]; i++)
+				{
+					u64 slot = (hashes[keys[i]] ^ displacement) & (Slots - 1);
+					taken[slot] = true;
+					placed[slot] = keys[i];
+				}
+			}
+		}
+
+		// Empty slots hold a copy of the first entry. A key landing on one can't be equal to it, as the first key
+		// has its own slot, so lookups never need to check if a slot is empty.
+		for (u64 slot = 0; slot < Slots; slot++)
+		{
+			m_Entries[slot] = entries[taken[slot] ? placed[slot] : 0];
+		}
+
+		return true;
+	}
+
+	u64 m_Seed = 0;
+	u64 m_Displacements[Slots] = {};
+	Pair<K, V> m_Entries[Slots] = {};
+};
+
+/// Build a StaticMap, deducing the number of entries.
+///
+/// \param entries Key-value pairs.
+///
+/// \return The StaticMap.
+template<typename K, typename V, u64 N>
+consteval StaticMap<K, V, N> MakeStaticMap(const Pair<K, V> (&entries)[N])
+{
+	return StaticMap<K, V, N>(entries);
+}
+
+}
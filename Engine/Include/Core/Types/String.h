@@ -4,8 +4,11 @@
 
 #pragma once
 
-#include "Core/Memory/RawAllocator.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Memory/MemoryTag.h"
 #include "Core/Types/BaseTypes.h"
+#include "Core/Types/Hash.h"
+#include "Core/Types/Traits.h"
 
 namespace Ignis {
 
@@ -73,17 +76,30 @@ public:
 	/// Default constructor.
 	StringRef() = default;
 
-	/// Construct a StringRef from a string literal.
+	/// Construct a StringRef from a string literal. Can be used in constant expressions.
 	/// Use StringView(const char* ptr, uint64 size) if you already know the size.
 	///
 	/// \param ptr Pointer to the first character of the literal.
-	StringRef(const char* ptr);
+	constexpr StringRef(const char* ptr) : m_Data(ptr)
+	{
+		if (std::is_constant_evaluated())
+		{
+			while (ptr[m_Size])
+			{
+				m_Size++;
+			}
+		}
+		else
+		{
+			m_Size = StrLen(ptr);
+		}
+	}
 
 	/// Construct a StringRef from a pointer with a size.
 	///
 	/// \param ptr Pointer to the first character of the literal.
 	/// \param size Size of the region in bytes.
-	StringRef(const char* ptr, u64 size);
+	constexpr StringRef(const char* ptr, u64 size) : m_Data(ptr), m_Size(size) {}
 
 	/// Construct a StringRef from a String. May be invalidated on appending to the String.
 	/// To prevent invalidation, first call Reserve on the String to ensure enough capacity exists.
@@ -94,7 +110,7 @@ public:
 	/// Get the size of the view into the string.
 	///
 	/// \return The size.
-	u64 Size() const;
+	constexpr u64 Size() const { return m_Size; }
 
 	/// Get the data the view points to.
 	///
@@ -114,7 +130,12 @@ public:
 	Iterator end() const;
 
 private:
-	const Byte* m_Data = nullptr;
+	friend constexpr bool operator==(StringRef first, StringRef second);
+
+	template<typename>
+	friend struct StaticHasher;
+
+	const char* m_Data = nullptr;
 	u64 m_Size = 0;
 };
 
@@ -124,28 +145,28 @@ class IGNIS_API String
 public:
 	/// Construct a String with an allocator.
 	///
-	/// \param alloc Allocator to use for memory allocation. Defaults to the Raw Allocator.
-	String(Allocator& alloc = GAlloc);
+	/// \param alloc Allocator to use for memory allocation. Defaults to the allocator of MemoryTag::Strings.
+	String(Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Strings));
 
 	/// Create a String from a string literal.
 	///
 	/// \param ptr Pointer to first character of string literal.
-	/// \param alloc Allocator to use for memory allocation. Defaults to the Raw Allocator.
-	String(const char* ptr, Allocator& alloc = GAlloc);
+	/// \param alloc Allocator to use for memory allocation. Defaults to the allocator of MemoryTag::Strings.
+	String(const char* ptr, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Strings));
 
 	/// Create a String from a StringRef.
 	///
 	/// \param ref StringRef to create the String from.
-	/// \param alloc Allocator to use for memory allocation. Defaults to the Raw Allocator.
-	String(StringRef ref, Allocator& alloc = GAlloc);
+	/// \param alloc Allocator to use for memory allocation. Defaults to the allocator of MemoryTag::Strings.
+	String(StringRef ref, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Strings));
 
 	/// Create a String with a size.
 	///
 	/// \param size The size of the String.
-	/// \param alloc Allocator to use for memory allocation. Defaults to the Raw Allocator.
+	/// \param alloc Allocator to use for memory allocation. Defaults to the allocator of MemoryTag::Strings.
 	///
 	/// \warning This should only be used if you are writing directly to the String's buffer with Data().
-	String(u64 size, Allocator& alloc = GAlloc);
+	String(u64 size, Allocator& alloc = MemoryTracking::GetAllocator(MemoryTag::Strings));
 
 	/// Copy constructor.
 	///
@@ -230,9 +251,6 @@ public:
 	Iterator end() const;
 
 private:
-	friend bool IGNIS_API operator==(const String& first, const String& second);
-	friend bool IGNIS_API operator!=(const String& first, const String& second);
-
 	bool IsSmall() const;
 	void SetSmall(bool isSmall);
 	void IncSize(u64 inc);
@@ -263,28 +281,74 @@ private:
 	} m_Repr;
 };
 
-bool IGNIS_API operator==(const String& first, const String& second);
-bool IGNIS_API operator!=(const String& first, const String& second);
+/// Compares Strings, StringRefs and literals alike, so comparing a String with a literal doesn't allocate.
+/// Can be used in constant expressions.
+constexpr bool operator==(StringRef first, StringRef second)
+{
+	if (first.m_Size != second.m_Size)
+	{
+		return false;
+	}
+
+	if (std::is_constant_evaluated())
+	{
+		for (u64 i = 0; i < first.m_Size; i++)
+		{
+			if (first.m_Data[i] != second.m_Data[i])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	return !first.m_Size || MemCompare(first.m_Data, second.m_Data, first.m_Size);
+}
+
+constexpr bool operator!=(StringRef first, StringRef second) { return !(first == second); }
+
+/// Orders strings by their bytes, so sorted containers can hold strings. Not a natural or locale-aware order.
+bool IGNIS_API operator<(StringRef first, StringRef second);
 
 String IGNIS_API operator+(StringRef first, StringRef second);
 
-template<typename>
-struct Hasher;
+/// Hasher for StringRef, uses HashBytes().
+/// Transparent, so maps keyed by StringRef can be searched with literals.
+template<>
+struct IGNIS_API Hasher<StringRef>
+{
+	using IsTransparent = void;
+
+	static u64 Hash(StringRef string);
+};
 
-/// Hasher for String, uses MurmurHash3:
-/// https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
+/// Hasher for String. Hashes the same as StringRef, so maps keyed by String can be searched with a StringRef without
+/// allocating a String.
 template<>
-struct IGNIS_API Hasher<String>
+struct Hasher<String> : Hasher<StringRef>
 {
-	static u64 Hash(const String& string);
 };
 
-/// Hasher for StringRef, uses MurmurHash3:
-/// https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
+namespace Traits {
+
+/// Small strings are stored inside the String itself, but never pointed to.
 template<>
-struct IGNIS_API Hasher<StringRef>
+struct IsTriviallyRelocatable<String> : std::true_type
 {
-	static u64 Hash(const StringRef& string);
 };
 
+/// Sorted containers keyed by strings can be searched with StringRefs and literals, without allocating a String.
+template<>
+struct IsTransparentlyOrdered<StringRef> : std::true_type
+{
+};
+
+template<>
+struct IsTransparentlyOrdered<String> : std::true_type
+{
+};
+
+}
+
 }
@@ -29,6 +29,28 @@ std::bool_constant<false> IsCompleteHelper(void*); // Undefined because only use
 template<typename T>
 using IsComplete = decltype(Private::IsCompleteHelper((T*) nullptr));
 
+/// Checking if a type can be moved to another address with a plain MemCopy(),
+/// without calling its move constructor and destructor. Containers use this to move elements in bulk.
+/// Is true for trivially copyable types. Specialize it for types that have no pointers into themselves,
+/// and don't register their address anywhere, such as types that only own heap memory.
+///
+/// \tparam T Type to check.
+template<typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>>
+{
+};
+
+/// Checking if sorted containers with keys of type T can be searched with other types, without converting them to T.
+/// Those types must order the same way as the key they would convert to. Specialize it as true for keys like strings,
+/// where converting the query would allocate. Is false by default, so that integers of other types are converted
+/// instead of being compared as signed and unsigned.
+///
+/// \tparam T Key type to check.
+template<typename T>
+struct IsTransparentlyOrdered : std::false_type
+{
+};
+
 }
 
 }
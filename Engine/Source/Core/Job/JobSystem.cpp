@@ -5,8 +5,15 @@
 #include <atomic>
 #include <thread>
 
+#ifdef ARCH_X64
+#	include <emmintrin.h>
+#endif
+
+#include "Core/Math/Random.h"
+#include "Core/Memory/TaggedAllocator.h"
 #include "Core/Misc/Log.h"
 #include "Core/Platform/Thread.h"
+#include "Core/Types/Queue.h"
 
 namespace Ignis {
 
@@ -14,30 +21,196 @@ namespace JobSystem {
 
 ILOG_CATEGORY_LOCAL(LogJobSystem, Verbose);
 
+/// Completion counter shared by the jobs of a submission.
+/// The high 32 bits are a generation, bumped every time the counter is reused, and the low 32 bits the jobs left.
+struct Counter
+{
+	std::atomic<u64> State = 0;
+};
+
+struct QueuedJob
+{
+	const Job* Target = nullptr;
+	Counter* Completion = nullptr;
+};
+
 static std::atomic_flag s_Initialized;
-static Array<Thread> s_Threads;
+static std::atomic<bool> s_Running;
+static ExecutionMode s_Mode = ExecutionMode::Parallel;
+static Array<Thread> s_Threads(MemoryTracking::GetAllocator(MemoryTag::Job));
+static MPMCQueue<QueuedJob> s_Queue;
+
+// Counters are recycled, a counter is only reused once all of its jobs have completed.
+static constexpr u64 s_CounterCount = 256;
+static Counter s_Counters[s_CounterCount];
+static std::atomic<u64> s_NextCounter = 0;
+
+// Deterministic mode has no outstanding jobs after Submit returns, so all submissions share one counter.
+static Counter s_Completed;
+static u64 s_RandomState = 0;
+
+// Idle threads spin for a bit, then yield, then sleep on s_Signal, so they don't hold on to a core without work.
+// s_Signal is bumped whenever jobs are queued or a submission completes, and only woken if someone is asleep.
+static constexpr u32 s_SpinCount = 64;
+static constexpr u32 s_YieldCount = 16;
+static std::atomic<u64> s_Signal = 0;
+static std::atomic<u32> s_Sleeping = 0;
+
+static void Pause()
+{
+#ifdef ARCH_X64
+	_mm_pause();
+#endif
+}
+
+static void Signal()
+{
+	s_Signal.fetch_add(1);
+	if (s_Sleeping.load())
+	{
+		s_Signal.notify_all();
+	}
+}
 
-class Counter : public WaitCondition
+static void Run(const QueuedJob& job)
 {
-public:
-	Counter() = default;
-	Counter(const Counter& other) : Count(other.Count.load()) {}
+	job.Target->Func(job.Target->Argument);
+	if (u32(job.Completion->State.fetch_sub(1)) == 1)
+	{
+		job.Completion->State.notify_all();
+		Signal();
+	}
+}
 
-	operator bool() const override { return Count == 0; }
+/// Run a queued job if there is one, otherwise back off.
+///
+/// \param idle Number of calls in a row that didn't find a job. Reset when a job is run.
+/// \param condition Condition being waited on, if any. Checked again before going to sleep.
+static void RunOrIdle(u32& idle, const WaitCondition* condition)
+{
+	QueuedJob job;
+	if (s_Queue.TryPop(job))
+	{
+		Run(job);
+		idle = 0;
+		return;
+	}
 
-	void SleepOn() const override
+	idle++;
+	if (idle < s_SpinCount)
 	{
-		while (Count > 0) {} // Busy wait :sob:
+		Pause();
+		return;
 	}
 
-	std::atomic<u64> Count = 0;
-};
+	if (idle < s_SpinCount + s_YieldCount)
+	{
+		std::this_thread::yield();
+		return;
+	}
+
+	// Register as sleeping before reading the signal, so a Signal() after the checks below always wakes us.
+	s_Sleeping.fetch_add(1);
+	u64 signal = s_Signal.load();
+	if (s_Queue.TryPop(job))
+	{
+		s_Sleeping.fetch_sub(1);
+		Run(job);
+		idle = 0;
+		return;
+	}
+
+	if (s_Running.load() && !(condition && *condition))
+	{
+		s_Signal.wait(signal);
+	}
+	s_Sleeping.fetch_sub(1);
+}
+
+/// Run a queued job if there is one, for a submitting thread waiting on a full queue or on a free counter.
+/// Never sleeps, as those free up without a Signal().
+static void Help()
+{
+	QueuedJob job;
+	if (s_Queue.TryPop(job))
+	{
+		Run(job);
+	}
+	else
+	{
+		Pause();
+	}
+}
+
+static void ThreadFunction()
+{
+	ILOG(LogJobSystem, Verbose, "Job System worker thread started");
+
+	u32 idle = 0;
+	while (s_Running.load(std::memory_order::relaxed))
+	{
+		RunOrIdle(idle, nullptr);
+	}
+}
 
-static void ThreadFunction() { 
-	ILOG(LogJobSystem, Verbose, "Job System worker thread started"); 
+Completion::operator bool() const
+{
+	u64 state = m_State->load(std::memory_order::acquire);
+	return u32(state >> 32) != m_Generation || u32(state) == 0;
 }
 
-void Initialize(u16 threadCount, u64 memUsage)
+void Completion::SleepOn() const
+{
+	while (true)
+	{
+		u64 state = m_State->load(std::memory_order::acquire);
+		if (u32(state >> 32) != m_Generation || u32(state) == 0)
+		{
+			return;
+		}
+
+		m_State->wait(state);
+	}
+}
+
+static u64 GCD(u64 a, u64 b)
+{
+	while (b)
+	{
+		u64 temp = a % b;
+		a = b;
+		b = temp;
+	}
+
+	return a;
+}
+
+/// Run the jobs inline, in a seeded order.
+/// Walks the jobs with a random start and a random stride coprime to the number of jobs,
+/// which visits every job exactly once without needing any storage, so nested submissions from jobs still work.
+static void RunDeterministic(ArrayRef<Job> jobs)
+{
+	u64 count = jobs.Size();
+	if (count == 0)
+	{
+		return;
+	}
+
+	u64 index = QuickRandom(s_RandomState) % count;
+	u64 stride = QuickRandom(s_RandomState) % count + 1;
+	while (GCD(stride, count) != 1)
+	{
+		stride--;
+	}
+
+	for (u64 i = 0; i < count; i++)
+	{
+		jobs[index].Func(jobs[index].Argument);
+		index = (index + stride) % count;
+	}
+}
+
+void Initialize(u16 threadCount, u64 memUsage, ExecutionMode mode, u64 seed)
 {
 	if (s_Initialized.test_and_set())
 	{
@@ -45,6 +218,15 @@ void Initialize(u16 threadCount, u64 memUsage)
 		return;
 	}
 
+	s_Mode = mode;
+	if (mode == ExecutionMode::Deterministic)
+	{
+		s_RandomState = seed ? seed : 123456789; // xorshift state can never be 0.
+
+		ILOG(LogJobSystem, Verbose, "Initializing Job System in deterministic mode with seed {}", seed);
+		return;
+	}
+
 	if (!threadCount)
 	{
 		threadCount = Thread::GetMaxThreads() - 1;
@@ -60,6 +242,9 @@ void Initialize(u16 threadCount, u64 memUsage)
 	ILOG(
 		LogJobSystem, Verbose, "Initializing Job System with {} threads, using {} MB of memory", threadCount, memUsage);
 
+	s_Queue = MPMCQueue<QueuedJob>(4096, MemoryTracking::GetAllocator(MemoryTag::Job));
+	s_Running = true;
+
 	s_Threads.Reserve(threadCount);
 	for (u64 i = 0; i < threadCount; i++)
 	{
@@ -67,6 +252,79 @@ void Initialize(u16 threadCount, u64 memUsage)
 	}
 }
 
+Completion Submit(ArrayRef<Job> jobs)
+{
+	IASSERT(s_Initialized.test(), "Job System has not been initialized!");
+
+	if (s_Mode == ExecutionMode::Deterministic)
+	{
+		RunDeterministic(jobs);
+		return Completion(&s_Completed.State, 0);
+	}
+
+	IASSERT(jobs.Size() <= u32(-1), "Too many jobs in a single submission");
+
+	// Counters only free up as jobs complete, so run jobs while every counter is busy.
+	Counter* counter = nullptr;
+	u32 generation = 0;
+	for (u64 attempt = 1;; attempt++)
+	{
+		counter = &s_Counters[s_NextCounter.fetch_add(1) % s_CounterCount];
+		u64 state = counter->State.load();
+		generation = u32(state >> 32) + 1;
+		if (u32(state) == 0 && counter->State.compare_exchange_strong(state, (u64(generation) << 32) | jobs.Size()))
+		{
+			break;
+		}
+
+		if (attempt % s_CounterCount == 0)
+		{
+			Help();
+		}
+	}
+
+	// The queue only frees up as jobs are run, so wake the workers and run jobs while it is full.
+	for (auto& job : jobs)
+	{
+		while (!s_Queue.TryPush(QueuedJob{ &job, counter }))
+		{
+			Signal();
+			Help();
+		}
+	}
+	Signal();
+
+	return Completion(&counter->State, generation);
+}
+
+void Wait(const WaitCondition& condition)
+{
+	if (s_Mode == ExecutionMode::Deterministic)
+	{
+		IASSERT(condition, "Waiting on an unsatisfied condition in deterministic mode would never wake up");
+		return;
+	}
+
+	// No fibers yet, so help out with the queue, and sleep until something happens when it is empty.
+	u32 idle = 0;
+	while (!condition)
+	{
+		RunOrIdle(idle, &condition);
+	}
+}
+
+void Quit()
+{
+	s_Running = false;
+	s_Signal.fetch_add(1);
+	s_Signal.notify_all();
+	for (auto& thread : s_Threads)
+	{
+		thread.Join();
+	}
+	s_Threads.Clear();
+}
+
 }
 
 }
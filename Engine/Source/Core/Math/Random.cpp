@@ -6,10 +6,15 @@ namespace Ignis {
 
 u64 QuickRandom()
 {
-	// Uses Marsaglia's xorshift*
-
 	static u64 state = 123456789;
 
+	return QuickRandom(state);
+}
+
+u64 QuickRandom(u64& state)
+{
+	// Uses Marsaglia's xorshift*
+
 	u64 x = state;
 	x ^= x >> 12;
 	x ^= x << 25;
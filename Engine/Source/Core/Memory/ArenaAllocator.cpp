@@ -0,0 +1,106 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Memory/ArenaAllocator.h"
+
+namespace Ignis {
+
+static u64 AlignUp(u64 size) { return (size + 15) & ~u64(15); }
+
+ArenaAllocator::ArenaAllocator(u64 chunkSize, Allocator& alloc) : m_Alloc(&alloc), m_ChunkSize(chunkSize) {}
+
+ArenaAllocator::~ArenaAllocator()
+{
+	while (m_Chunk)
+	{
+		Chunk* next = m_Chunk->Next;
+		m_Alloc->Deallocate(m_Chunk);
+		m_Chunk = next;
+	}
+}
+
+void* ArenaAllocator::Allocate(u64 size) { return Allocate(size, 16); }
+
+void* ArenaAllocator::Allocate(u64 size, u64 alignment)
+{
+	size = AlignUp(size);
+	u64 padding = (alignment - u64(m_Current) % alignment) % alignment;
+	if (u64(m_End - m_Current) < padding + size || !m_Current)
+	{
+		u64 required = size + (alignment > 16 ? alignment : 0); // Chunk data is only 16 byte aligned.
+		if (!NewChunk(required > m_ChunkSize ? required : m_ChunkSize))
+		{
+			return nullptr;
+		}
+		padding = (alignment - u64(m_Current) % alignment) % alignment;
+	}
+
+	m_Last = m_Current + padding;
+	m_Current = m_Last + size;
+	m_Used += padding + size;
+
+	return m_Last;
+}
+
+void ArenaAllocator::Deallocate([[maybe_unused]] void* ptr) {}
+
+u64 ArenaAllocator::GrowAllocation(void* ptr, u64 oldSize, u64 newSize)
+{
+	if (ptr != m_Last || !ptr)
+	{
+		return oldSize;
+	}
+
+	newSize = AlignUp(newSize);
+	if (u64(m_End - m_Last) < newSize)
+	{
+		return oldSize;
+	}
+
+	m_Used += newSize - u64(m_Current - m_Last);
+	m_Current = m_Last + newSize;
+
+	return newSize;
+}
+
+void ArenaAllocator::Reset()
+{
+	if (!m_Chunk)
+	{
+		return;
+	}
+
+	Chunk* old = m_Chunk->Next;
+	while (old)
+	{
+		Chunk* next = old->Next;
+		m_Alloc->Deallocate(old);
+		old = next;
+	}
+
+	m_Chunk->Next = nullptr;
+	m_Current = reinterpret_cast<u8*>(m_Chunk + 1);
+	m_Last = nullptr;
+	m_Used = 0;
+}
+
+u64 ArenaAllocator::GetUsed() const { return m_Used; }
+
+bool ArenaAllocator::NewChunk(u64 size)
+{
+	auto chunk = reinterpret_cast<Chunk*>(m_Alloc->Allocate(sizeof(Chunk) + size));
+	if (!chunk)
+	{
+		return false;
+	}
+
+	chunk->Next = m_Chunk;
+	chunk->Size = size;
+
+	m_Chunk = chunk;
+	m_Current = reinterpret_cast<u8*>(chunk + 1);
+	m_End = m_Current + size;
+
+	return true;
+}
+
+}
@@ -0,0 +1,96 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Memory/Epoch.h"
+
+#include "Core/Platform/Thread.h"
+
+namespace Ignis {
+
+EpochDomain::Guard::Guard(const EpochDomain& domain)
+{
+	u64 stripe = Thread::GetCurrentIndex() % StripeCount;
+	while (true)
+	{
+		u64 epoch = domain.m_Epoch.load();
+		m_Counter = &domain.m_Readers[epoch & 1][stripe].Count;
+		m_Counter->fetch_add(1);
+
+		// If the epoch moved on before the reader was counted, the writer might not have seen it, so count it again.
+		if (domain.m_Epoch.load() == epoch)
+		{
+			return;
+		}
+
+		m_Counter->fetch_sub(1);
+	}
+}
+
+EpochDomain::Guard::~Guard() { m_Counter->fetch_sub(1, std::memory_order::release); }
+
+EpochDomain::EpochDomain(Allocator& alloc) : m_Retired(alloc) {}
+
+EpochDomain::~EpochDomain()
+{
+	for (auto& retired : m_Retired)
+	{
+		retired.Free(retired.Ptr, retired.Context);
+	}
+}
+
+void EpochDomain::Retire(void* ptr, Deleter deleter, void* context)
+{
+	while (m_Lock.test_and_set(std::memory_order::acquire)) {}
+
+	m_Retired.Push({ ptr, deleter, context, m_Epoch.load() });
+	bool reclaim = ++m_SinceReclaim >= ReclaimInterval;
+
+	m_Lock.clear(std::memory_order::release);
+
+	if (reclaim)
+	{
+		Reclaim();
+	}
+}
+
+void EpochDomain::Reclaim()
+{
+	while (m_Lock.test_and_set(std::memory_order::acquire)) {}
+
+	m_SinceReclaim = 0;
+
+	// Memory retired in an epoch can be reached by readers of that epoch and the one before it,
+	// so it is freed two epochs later. Moving on to the next epoch needs the readers of the previous one to be gone.
+	for (u64 step = 0; step < 2; step++)
+	{
+		u64 epoch = m_Epoch.load();
+		bool readers = false;
+		for (auto& stripe : m_Readers[(epoch + 1) & 1])
+		{
+			readers |= stripe.Count.load() != 0;
+		}
+
+		if (readers)
+		{
+			break;
+		}
+		m_Epoch.store(epoch + 1);
+	}
+
+	u64 epoch = m_Epoch.load();
+	for (u64 i = 0; i < m_Retired.Size();)
+	{
+		if (m_Retired[i].Epoch + 2 <= epoch)
+		{
+			m_Retired[i].Free(m_Retired[i].Ptr, m_Retired[i].Context);
+			m_Retired.RemoveSwap(i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	m_Lock.clear(std::memory_order::release);
+}
+
+}
@@ -0,0 +1,286 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Memory/HandleHeap.h"
+
+#include "Core/Job/JobSystem.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Platform/VirtualMemory.h"
+
+namespace Ignis {
+
+/// Memory is committed and decommitted in steps of this many bytes.
+static constexpr u64 CommitStep = 64 * 1024;
+
+/// m_FirstHole when there are no holes.
+static constexpr u64 NoHole = u64(-1);
+
+static constexpr u32 WriterBit = u32(1) << 31;
+
+static u64 AlignUp(u64 value, u64 alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+HandleHeap::ReadScope::ReadScope(const HandleHeap& heap) : m_Heap(heap) { m_Heap.LockShared(); }
+
+HandleHeap::ReadScope::~ReadScope() { m_Heap.UnlockShared(); }
+
+HandleHeap::HandleHeap(u64 capacity, Allocator& alloc)
+	: m_Capacity(AlignUp(capacity, CommitStep)), m_FirstHole(NoHole), m_Slots(alloc),
+	  m_CompactCallable(&HandleHeap::RunCompaction, this)
+{
+	m_Base = reinterpret_cast<u8*>(VirtualMemory::Reserve(m_Capacity));
+}
+
+HandleHeap::~HandleHeap()
+{
+	if (m_Base)
+	{
+		VirtualMemory::Release(m_Base, m_Capacity);
+	}
+}
+
+HeapHandle HandleHeap::Allocate(u64 size)
+{
+	u64 blockSize = AlignUp(sizeof(Block) + size, 16);
+
+	Lock();
+
+	u64 offset = m_Top;
+	if (!Reserve(offset + blockSize))
+	{
+		Unlock();
+		return {};
+	}
+
+	u32 index = m_FreeSlots;
+	if (index != FreeSlot)
+	{
+		m_FreeSlots = u32(m_Slots[index].Offset);
+	}
+	else
+	{
+		index = u32(m_Slots.Size());
+		m_Slots.Push({ 0, 1, false });
+	}
+
+	Slot& slot = m_Slots[index];
+	slot.Offset = offset + sizeof(Block);
+	slot.Live = true;
+
+	auto block = reinterpret_cast<Block*>(m_Base + offset);
+	block->Slot = index;
+	block->Size = blockSize;
+
+	m_Top += blockSize;
+	m_Live += blockSize;
+	HeapHandle handle = { index, slot.Generation };
+
+	Unlock();
+
+	return handle;
+}
+
+void HandleHeap::Deallocate(HeapHandle handle)
+{
+	Lock();
+
+	if (!IsValidLocked(handle))
+	{
+		Unlock();
+		return;
+	}
+
+	Slot& slot = m_Slots[handle.Index];
+	u64 offset = slot.Offset - sizeof(Block);
+	auto block = reinterpret_cast<Block*>(m_Base + offset);
+	block->Slot = FreeSlot;
+	m_Live -= block->Size;
+
+	slot.Live = false;
+	slot.Generation = slot.Generation == u32(-1) ? 1 : slot.Generation + 1;
+	slot.Offset = m_FreeSlots;
+	m_FreeSlots = handle.Index;
+
+	if (!m_Compacting && offset + block->Size == m_Top)
+	{
+		// The last block can just be popped off, without leaving a hole.
+		m_Top = offset;
+	}
+	else if ((!m_Compacting || offset < m_Destination) && offset < m_FirstHole)
+	{
+		// Holes past the scan of a pass in progress are handled by that pass.
+		m_FirstHole = offset;
+	}
+
+	Unlock();
+}
+
+void* HandleHeap::Get(HeapHandle handle) const
+{
+	LockShared();
+	void* ptr = IsValidLocked(handle) ? m_Base + m_Slots[handle.Index].Offset : nullptr;
+	UnlockShared();
+
+	return ptr;
+}
+
+bool HandleHeap::IsValid(HeapHandle handle) const
+{
+	LockShared();
+	bool valid = IsValidLocked(handle);
+	UnlockShared();
+
+	return valid;
+}
+
+bool HandleHeap::IsValidLocked(HeapHandle handle) const
+{
+	if (handle.Index >= m_Slots.Size())
+	{
+		return false;
+	}
+
+	const Slot& slot = m_Slots[handle.Index];
+	return slot.Live && slot.Generation == handle.Generation;
+}
+
+bool HandleHeap::Compact(u64 maxBytes)
+{
+	Lock();
+
+	if (!m_Compacting)
+	{
+		if (m_FirstHole >= m_Top)
+		{
+			m_FirstHole = NoHole;
+			Unlock();
+			return true;
+		}
+
+		m_Compacting = true;
+		m_Destination = m_FirstHole;
+		m_Scan = m_FirstHole;
+		m_FirstHole = NoHole;
+	}
+
+	u64 moved = 0;
+	while (m_Scan < m_Top && moved < maxBytes)
+	{
+		auto block = reinterpret_cast<Block*>(m_Base + m_Scan);
+		u64 size = block->Size;
+		u32 slot = block->Slot;
+		if (slot != FreeSlot)
+		{
+			if (m_Scan != m_Destination)
+			{
+				// The block can overlap its new location if it is larger than the gap.
+				MemMove(m_Base + m_Destination, block, size);
+				m_Slots[slot].Offset = m_Destination + sizeof(Block);
+				moved += size;
+			}
+			m_Destination += size;
+		}
+		m_Scan += size;
+	}
+
+	bool done = false;
+	if (m_Scan == m_Top)
+	{
+		m_Compacting = false;
+		m_Top = m_Destination;
+
+		u64 committed = AlignUp(m_Top, CommitStep);
+		if (committed < m_Committed)
+		{
+			VirtualMemory::Decommit(m_Base + committed, m_Committed - committed);
+			m_Committed = committed;
+		}
+
+		// Objects freed below the scan during the pass left holes for the next pass.
+		done = m_FirstHole == NoHole;
+	}
+
+	Unlock();
+
+	return done;
+}
+
+JobSystem::Completion HandleHeap::CompactAsync(u64 maxBytes)
+{
+	m_StepBytes = maxBytes;
+	m_CompactJob.Func = m_CompactCallable;
+	return JobSystem::Submit(ArrayRef<Job>(&m_CompactJob, 1));
+}
+
+u64 HandleHeap::GetLive() const
+{
+	LockShared();
+	u64 live = m_Live;
+	UnlockShared();
+
+	return live;
+}
+
+u64 HandleHeap::GetUsed() const
+{
+	LockShared();
+	u64 used = m_Top;
+	UnlockShared();
+
+	return used;
+}
+
+void HandleHeap::LockShared() const
+{
+	u32 value = m_Lock.load(std::memory_order::relaxed);
+	while (true)
+	{
+		if (value & WriterBit)
+		{
+			value = m_Lock.load(std::memory_order::relaxed);
+			continue;
+		}
+
+		if (m_Lock.compare_exchange_weak(value, value + 1, std::memory_order::acquire, std::memory_order::relaxed))
+		{
+			return;
+		}
+	}
+}
+
+void HandleHeap::UnlockShared() const { m_Lock.fetch_sub(1, std::memory_order::release); }
+
+void HandleHeap::Lock()
+{
+	u32 expected = 0;
+	while (!m_Lock.compare_exchange_weak(expected, WriterBit, std::memory_order::acquire, std::memory_order::relaxed))
+	{
+		expected = 0;
+	}
+}
+
+void HandleHeap::Unlock() { m_Lock.store(0, std::memory_order::release); }
+
+bool HandleHeap::Reserve(u64 top)
+{
+	if (top <= m_Committed)
+	{
+		return true;
+	}
+
+	if (!m_Base || top > m_Capacity)
+	{
+		return false;
+	}
+
+	u64 committed = AlignUp(top, CommitStep);
+	if (!VirtualMemory::Commit(m_Base + m_Committed, committed - m_Committed))
+	{
+		return false;
+	}
+	m_Committed = committed;
+
+	return true;
+}
+
+void HandleHeap::RunCompaction(AnyRef) { Compact(m_StepBytes); }
+
+}
@@ -4,12 +4,258 @@
 
 #include <cstring>
 
+#ifdef ARCH_X64
+#	ifdef COMPILER_MSVC
+#		include <intrin.h>
+#		define TARGET_AVX2
+#	else
+#		include <immintrin.h>
+#		define TARGET_AVX2 __attribute__((target("avx2")))
+#	endif
+#endif
+
 namespace Ignis {
 
 void MemCopy(void* destination, const void* source, u64 size) { memcpy(destination, source, size); }
 
+void MemMove(void* destination, const void* source, u64 size) { memmove(destination, source, size); }
+
 void MemSet(void* destination, Byte value, u64 size) { memset(destination, value, size); }
 
 bool MemCompare(const void* first, const void* second, u64 size) { return memcmp(first, second, size) == 0; }
 
+#ifdef ARCH_X64
+
+static bool HasAVX2()
+{
+	static const bool avx2 = []
+	{
+#	ifdef COMPILER_MSVC
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+
+		// The OS must also save the YMM registers on context switches.
+		__cpuid(info, 1);
+		bool osxsave = info[2] & (1 << 27);
+		bool avx = info[2] & (1 << 28);
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#	else
+		// Might run during static initialization, before the CPU model is filled in.
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#	endif
+	}();
+
+	return avx2;
+}
+
+static u64 CountTrailingZeros(u32 value)
+{
+#	ifdef COMPILER_MSVC
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return index;
+#	else
+	return __builtin_ctz(value);
+#	endif
+}
+
+void MemCopyStreaming(void* destination, const void* source, u64 size)
+{
+	if (size < StreamingThreshold)
+	{
+		memcpy(destination, source, size);
+		return;
+	}
+
+	auto dst = reinterpret_cast<u8*>(destination);
+	auto src = reinterpret_cast<const u8*>(source);
+
+	// Non-temporal stores must be aligned, so copy up to the first 16 byte boundary normally.
+	u64 head = (16 - (u64(dst) & 15)) & 15;
+	memcpy(dst, src, head);
+	dst += head;
+	src += head;
+	size -= head;
+
+	u64 body = size & ~u64(63);
+	for (u64 i = 0; i < body; i += 64)
+	{
+		_mm_prefetch(reinterpret_cast<const char*>(src + i + 512), _MM_HINT_NTA);
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), a);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 16), b);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 32), c);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 48), d);
+	}
+
+	// Non-temporal stores are weakly ordered, so make them visible before anything written after the copy.
+	_mm_sfence();
+	memcpy(dst + body, src + body, size - body);
+}
+
+void MemSetStreaming(void* destination, Byte value, u64 size)
+{
+	if (size < StreamingThreshold)
+	{
+		memset(destination, value, size);
+		return;
+	}
+
+	auto dst = reinterpret_cast<u8*>(destination);
+	u64 head = (16 - (u64(dst) & 15)) & 15;
+	memset(dst, value, head);
+	dst += head;
+	size -= head;
+
+	__m128i fill = _mm_set1_epi8(char(u8(value)));
+	u64 body = size & ~u64(63);
+	for (u64 i = 0; i < body; i += 64)
+	{
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), fill);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 16), fill);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 32), fill);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 48), fill);
+	}
+
+	_mm_sfence();
+	memset(dst + body, value, size - body);
+}
+
+TARGET_AVX2 static const void* MemFindAVX2(const u8* ptr, u8 value, u64 size)
+{
+	__m256i needle = _mm256_set1_epi8(char(value));
+	u64 i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+		u32 mask = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, needle)));
+		if (mask)
+		{
+			return ptr + i + CountTrailingZeros(mask);
+		}
+	}
+
+	return memchr(ptr + i, value, size - i);
+}
+
+static const void* MemFindSSE2(const u8* ptr, u8 value, u64 size)
+{
+	__m128i needle = _mm_set1_epi8(char(value));
+	u64 i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+		u32 mask = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, needle)));
+		if (mask)
+		{
+			return ptr + i + CountTrailingZeros(mask);
+		}
+	}
+
+	return memchr(ptr + i, value, size - i);
+}
+
+const void* MemFind(const void* ptr, Byte value, u64 size)
+{
+	auto bytes = reinterpret_cast<const u8*>(ptr);
+	return HasAVX2() ? MemFindAVX2(bytes, value, size) : MemFindSSE2(bytes, value, size);
+}
+
+TARGET_AVX2 static u64 MemCountAVX2(const u8* ptr, u8 value, u64 size)
+{
+	__m256i needle = _mm256_set1_epi8(char(value));
+	__m256i zero = _mm256_setzero_si256();
+	__m256i totals = zero;
+	u64 i = 0;
+	while (i + 32 <= size)
+	{
+		// Matches are -1, so subtracting them counts up in every byte lane, which can only hold 255 before overflowing.
+		__m256i counts = zero;
+		for (u64 block = 0; block < 255 && i + 32 <= size; block++, i += 32)
+		{
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+			counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(bytes, needle));
+		}
+		totals = _mm256_add_epi64(totals, _mm256_sad_epu8(counts, zero));
+	}
+
+	u64 count = u64(_mm256_extract_epi64(totals, 0)) + u64(_mm256_extract_epi64(totals, 1)) +
+		u64(_mm256_extract_epi64(totals, 2)) + u64(_mm256_extract_epi64(totals, 3));
+	for (; i < size; i++)
+	{
+		count += ptr[i] == value;
+	}
+
+	return count;
+}
+
+static u64 MemCountSSE2(const u8* ptr, u8 value, u64 size)
+{
+	__m128i needle = _mm_set1_epi8(char(value));
+	__m128i zero = _mm_setzero_si128();
+	__m128i totals = zero;
+	u64 i = 0;
+	while (i + 16 <= size)
+	{
+		__m128i counts = zero;
+		for (u64 block = 0; block < 255 && i + 16 <= size; block++, i += 16)
+		{
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+			counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(bytes, needle));
+		}
+		totals = _mm_add_epi64(totals, _mm_sad_epu8(counts, zero));
+	}
+
+	u64 count = u64(_mm_cvtsi128_si64(totals)) + u64(_mm_cvtsi128_si64(_mm_unpackhi_epi64(totals, totals)));
+	for (; i < size; i++)
+	{
+		count += ptr[i] == value;
+	}
+
+	return count;
+}
+
+u64 MemCount(const void* ptr, Byte value, u64 size)
+{
+	auto bytes = reinterpret_cast<const u8*>(ptr);
+	return HasAVX2() ? MemCountAVX2(bytes, value, size) : MemCountSSE2(bytes, value, size);
+}
+
+#else
+
+void MemCopyStreaming(void* destination, const void* source, u64 size) { memcpy(destination, source, size); }
+
+void MemSetStreaming(void* destination, Byte value, u64 size) { memset(destination, value, size); }
+
+const void* MemFind(const void* ptr, Byte value, u64 size) { return memchr(ptr, u8(value), size); }
+
+u64 MemCount(const void* ptr, Byte value, u64 size)
+{
+	// Simple enough for the compiler to vectorize with NEON.
+	auto bytes = reinterpret_cast<const u8*>(ptr);
+	u64 count = 0;
+	for (u64 i = 0; i < size; i++)
+	{
+		count += bytes[i] == value;
+	}
+
+	return count;
+}
+
+#endif
+
 }
@@ -4,20 +4,221 @@
 
 #include <cstdlib>
 
+#include "Core/Memory/ThreadCacheAllocator.h"
+#include "Core/Platform/VirtualMemory.h"
+
 namespace Ignis {
 
-/// Ensuring that GAlloc is constructed before anything else and destroyed last.
+/// Ensuring that GRawAlloc is constructed before anything else and destroyed last.
 #ifdef COMPILER_MSVC
 #	pragma init_seg(lib)
-RawAllocator GAlloc;
+RawAllocator GRawAlloc;
 #else
-RawAllocator GAlloc __attribute__((init_priority(101)));
+RawAllocator GRawAlloc __attribute__((init_priority(101)));
 #endif
 
-void* RawAllocator::Allocate(u64 size) { return malloc(size); }
+#ifdef IGNIS_THREAD_CACHE_ALLOCATOR
+Allocator& GAlloc = GCacheAlloc;
+#else
+Allocator& GAlloc = GRawAlloc;
+#endif
+
+/// Header right before every pointer handed out.
+struct BlockHeader
+{
+	/// Distance from the start of the heap block or mapping to the pointer.
+	u64 Offset;
+
+	/// Whether the block has a mapping to itself.
+	u64 Mapped;
+};
+
+/// Header at the start of every mapping.
+struct MappingHeader
+{
+	/// Bytes of address space reserved for the mapping.
+	u64 Reserved;
+
+	/// Bytes at the start of the mapping that are readable and writable.
+	u64 Committed;
+
+	/// Huge pages backing the mapping.
+	VirtualMemory::HugePages Pages;
+};
+
+static u64 AlignUp(u64 value, u64 alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+static BlockHeader* GetHeader(void* ptr) { return reinterpret_cast<BlockHeader*>(ptr) - 1; }
+
+void* RawAllocator::Allocate(u64 size) { return Allocate(size, 16); }
+
+void* RawAllocator::Allocate(u64 size, u64 alignment)
+{
+	if (alignment < sizeof(BlockHeader))
+	{
+		alignment = sizeof(BlockHeader);
+	}
+
+	if (size >= MapThreshold)
+	{
+		return AllocateMapped(size, alignment);
+	}
+
+	// The heap is 16 byte aligned, so aligning past the header never moves the pointer more than alignment bytes.
+	auto block = reinterpret_cast<u8*>(malloc(size + alignment));
+	if (!block)
+	{
+		return nullptr;
+	}
+
+	auto ptr = reinterpret_cast<u8*>(AlignUp(u64(block) + sizeof(BlockHeader), alignment));
+	*GetHeader(ptr) = { u64(ptr - block), false };
+
+	return ptr;
+}
+
+void RawAllocator::Deallocate(void* ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	BlockHeader* header = GetHeader(ptr);
+	u8* block = reinterpret_cast<u8*>(ptr) - header->Offset;
+	if (header->Mapped)
+	{
+		VirtualMemory::Release(block, reinterpret_cast<MappingHeader*>(block)->Reserved);
+	}
+	else
+	{
+		free(block);
+	}
+}
+
+u64 RawAllocator::GrowAllocation(void* ptr, u64 oldSize, u64 newSize)
+{
+	if (!ptr || !GetHeader(ptr)->Mapped)
+	{
+		return oldSize;
+	}
+
+	u64 offset = GetHeader(ptr)->Offset;
+	u8* mapping = reinterpret_cast<u8*>(ptr) - offset;
+	auto header = reinterpret_cast<MappingHeader*>(mapping);
+	if (offset + newSize <= header->Committed)
+	{
+		return header->Committed - offset;
+	}
+
+	// Explicit huge pages are committed all at once, and can't be remapped in page sized steps.
+	if (header->Pages == VirtualMemory::HugePages::Explicit)
+	{
+		return header->Committed - offset;
+	}
+
+	// Transparent huge pages only back whole huge pages that are committed, so commit in huge page steps.
+	bool huge = header->Pages == VirtualMemory::HugePages::TransparentRequested;
+	u64 required = AlignUp(offset + newSize, huge ? VirtualMemory::GetHugePageSize() : VirtualMemory::GetPageSize());
+	if (required > header->Reserved)
+	{
+		// Out of reserved address space, so commit all of it to make the mapping a single region and try to extend it.
+		// Doubling keeps the number of remaps logarithmic.
+		if (header->Committed < header->Reserved)
+		{
+			if (!VirtualMemory::Commit(mapping + header->Committed, header->Reserved - header->Committed))
+			{
+				return header->Committed - offset;
+			}
+			header->Committed = header->Reserved;
+		}
+
+		u64 reserve = required > header->Reserved * 2 ? required : header->Reserved * 2;
+		if (!VirtualMemory::ExtendReservation(mapping, header->Reserved, reserve))
+		{
+			return header->Committed - offset;
+		}
+
+		// The new pages are part of the committed region already.
+		header->Reserved = reserve;
+		header->Committed = reserve;
+		return header->Committed - offset;
+	}
+
+	if (!VirtualMemory::Commit(mapping + header->Committed, required - header->Committed))
+	{
+		return header->Committed - offset;
+	}
+	header->Committed = required;
+
+	return header->Committed - offset;
+}
+
+void RawAllocator::SetUseHugePages(bool use) { m_UseHugePages.store(use, std::memory_order::relaxed); }
 
-void RawAllocator::Deallocate(void* ptr) { free(ptr); }
+VirtualMemory::HugePages RawAllocator::GetHugePages(void* ptr) const
+{
+	if (!ptr || !GetHeader(ptr)->Mapped)
+	{
+		return VirtualMemory::HugePages::None;
+	}
 
-u64 RawAllocator::GrowAllocation(void* ptr, u64 oldSize, u64 newSize) { return oldSize; }
+	return reinterpret_cast<MappingHeader*>(reinterpret_cast<u8*>(ptr) - GetHeader(ptr)->Offset)->Pages;
+}
+
+void* RawAllocator::AllocateMapped(u64 size, u64 alignment)
+{
+	u64 headers = sizeof(MappingHeader) + sizeof(BlockHeader);
+	u64 hugeSize = VirtualMemory::GetHugePageSize();
+	bool huge = m_UseHugePages.load(std::memory_order::relaxed) && hugeSize && size >= hugeSize;
+	if (huge && alignment <= hugeSize)
+	{
+		// Explicit huge pages can't be reserved ahead of time, so the block only gets what it needs.
+		u64 offset = AlignUp(headers, alignment);
+		u64 committed = AlignUp(offset + size, hugeSize);
+		if (auto mapping = reinterpret_cast<u8*>(VirtualMemory::CommitHuge(committed)))
+		{
+			*reinterpret_cast<MappingHeader*>(mapping) = { committed, committed, VirtualMemory::HugePages::Explicit };
+			*GetHeader(mapping + offset) = { offset, true };
+			return mapping + offset;
+		}
+	}
+
+	// Transparent huge pages only back whole huge pages, so start the mapping on a huge page boundary, and reserve and
+	// commit whole huge pages.
+	u64 granularity = huge ? hugeSize : VirtualMemory::GetPageSize();
+
+	// Leave room for a few doublings, address space is cheap.
+	u64 slack = alignment > granularity ? alignment : 0;
+	u64 reserve = size * 4 > MinReservation ? size * 4 : MinReservation;
+	reserve = AlignUp(reserve + headers + slack, granularity);
+
+	auto mapping = reinterpret_cast<u8*>(
+		huge ? VirtualMemory::ReserveAligned(reserve, hugeSize) : VirtualMemory::Reserve(reserve));
+	if (!mapping)
+	{
+		return nullptr;
+	}
+
+	auto ptr = reinterpret_cast<u8*>(AlignUp(u64(mapping) + headers, alignment));
+	u64 offset = u64(ptr - mapping);
+	u64 committed = AlignUp(offset + size, granularity);
+	if (!VirtualMemory::Commit(mapping, committed))
+	{
+		VirtualMemory::Release(mapping, reserve);
+		return nullptr;
+	}
+
+	VirtualMemory::HugePages pages = VirtualMemory::HugePages::None;
+	if (huge && VirtualMemory::AdviseHugePages(mapping, reserve))
+	{
+		pages = VirtualMemory::HugePages::TransparentRequested;
+	}
+
+	*reinterpret_cast<MappingHeader*>(mapping) = { reserve, committed, pages };
+	*GetHeader(ptr) = { offset, true };
+
+	return ptr;
+}
 
 }
@@ -0,0 +1,155 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Memory/StackAllocator.h"
+
+#include "Core/Misc/Assert.h"
+#include "Core/Platform/VirtualMemory.h"
+
+namespace Ignis {
+
+/// Memory is committed in steps of this many bytes, so that small allocations don't each make a system call.
+static constexpr u64 CommitStep = 64 * 1024;
+
+static u64 AlignUp(u64 value, u64 alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+StackAllocator::StackAllocator(u64 capacity)
+	: m_Capacity(AlignUp(capacity, CommitStep))
+{
+	m_Base = reinterpret_cast<u8*>(VirtualMemory::Reserve(m_Capacity));
+	m_Top = m_Base;
+}
+
+StackAllocator::~StackAllocator()
+{
+	if (m_Base)
+	{
+		VirtualMemory::Release(m_Base, m_Capacity);
+	}
+}
+
+void* StackAllocator::Allocate(u64 size) { return Allocate(size, 16); }
+
+void* StackAllocator::Allocate(u64 size, u64 alignment)
+{
+	if (alignment < 16)
+	{
+		alignment = 16;
+	}
+
+	auto ptr = reinterpret_cast<u8*>(AlignUp(u64(m_Top) + sizeof(Header), alignment));
+	u8* end = ptr + AlignUp(size, 16);
+	if (!Reserve(end))
+	{
+		return nullptr;
+	}
+
+	auto header = reinterpret_cast<Header*>(ptr) - 1;
+	header->Previous = m_Last;
+	header->Start = m_Top;
+
+	m_Last = ptr;
+	m_Top = end;
+
+	return ptr;
+}
+
+void StackAllocator::Deallocate(void* ptr)
+{
+	if (!ptr || ptr >= m_Top)
+	{
+		return;
+	}
+
+	auto header = reinterpret_cast<Header*>(ptr) - 1;
+	if (ptr != m_Last)
+	{
+		// Not on top, so it can only be given back once everything above it is gone.
+		header->Previous = reinterpret_cast<u8*>(u64(header->Previous) | FreedBit);
+		return;
+	}
+
+	m_Top = header->Start;
+	m_Last = header->Previous;
+	PopFreed();
+}
+
+u64 StackAllocator::GrowAllocation(void* ptr, u64 oldSize, u64 newSize)
+{
+	if (!ptr || ptr != m_Last)
+	{
+		return oldSize;
+	}
+
+	u8* end = m_Last + AlignUp(newSize, 16);
+	if (!Reserve(end))
+	{
+		return oldSize;
+	}
+
+	m_Top = end;
+
+	return u64(end - m_Last);
+}
+
+StackAllocator::Marker StackAllocator::GetMarker() const { return { m_Top, m_Last }; }
+
+void StackAllocator::FreeToMarker(Marker marker)
+{
+	IASSERT(marker.Top <= m_Top, "Stack has already been freed past the marker");
+	m_Top = marker.Top;
+	m_Last = marker.Last;
+	PopFreed();
+}
+
+void StackAllocator::Trim()
+{
+	u64 used = AlignUp(u64(m_Top - m_Base), CommitStep);
+	if (used < m_Committed)
+	{
+		VirtualMemory::Decommit(m_Base + used, m_Committed - used);
+		m_Committed = used;
+	}
+}
+
+u64 StackAllocator::GetUsed() const { return u64(m_Top - m_Base); }
+
+void StackAllocator::PopFreed()
+{
+	while (m_Last)
+	{
+		auto header = reinterpret_cast<Header*>(m_Last) - 1;
+		if (!(u64(header->Previous) & FreedBit))
+		{
+			return;
+		}
+
+		m_Top = header->Start;
+		m_Last = reinterpret_cast<u8*>(u64(header->Previous) & ~FreedBit);
+	}
+}
+
+bool StackAllocator::Reserve(u8* end)
+{
+	u64 required = u64(end - m_Base);
+	if (required <= m_Committed)
+	{
+		return true;
+	}
+
+	if (required > m_Capacity)
+	{
+		IASSERT(false, "StackAllocator is full");
+		return false;
+	}
+
+	u64 committed = AlignUp(required, CommitStep);
+	if (!VirtualMemory::Commit(m_Base + m_Committed, committed - m_Committed))
+	{
+		return false;
+	}
+	m_Committed = committed;
+
+	return true;
+}
+
+}
@@ -0,0 +1,352 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Memory/TaggedAllocator.h"
+
+#include <atomic>
+
+#include "Core/Misc/Log.h"
+#include "Core/Types/Pair.h"
+
+#ifdef COMPILER_MSVC
+#	include <intrin.h>
+#	define CALL_SITE() _ReturnAddress()
+#else
+#	define CALL_SITE() __builtin_return_address(0)
+#endif
+
+namespace Ignis {
+
+ILOG_CATEGORY_LOCAL(LogMemory, Verbose);
+
+/// Header right before every pointer handed out.
+struct TagHeader
+{
+#ifndef NDEBUG
+	/// Neighbours in the list of live allocations of the tag.
+	TagHeader* Prev;
+	TagHeader* Next;
+
+	/// Return address of the call to Allocate.
+	void* CallSite;
+
+	/// Keeps the header a multiple of 16 bytes.
+	u64 Padding;
+#endif
+
+	/// Usable size of the allocation.
+	u64 Size;
+
+	/// Distance from the start of the allocation to the pointer.
+	u64 Offset;
+};
+
+static_assert(sizeof(TagHeader) % 16 == 0, "TagHeader must keep 16 byte alignment");
+
+struct TagState
+{
+	std::atomic<u64> Live;
+	std::atomic<u64> Peak;
+	std::atomic<u64> Count;
+	std::atomic<u64> Total;
+	std::atomic<u64> Budget;
+
+#ifndef NDEBUG
+	std::atomic_flag Lock;
+	TagHeader* Head;
+#endif
+};
+
+static void LogOverBudget(MemoryTag tag, u64 live, u64 budget);
+
+// All of these are constant initialized, so they can be used before static initialization is done.
+constinit static TagState s_Tags[MaxMemoryTags];
+static const char* s_Names[MaxMemoryTags] = { "Untagged", "Job", "Containers", "Strings", "Log", "Reflection" };
+constinit static std::atomic<MemoryTracking::BudgetHandler> s_BudgetHandler = &LogOverBudget;
+
+// The budget handler might allocate from the tag that is over budget.
+static thread_local bool t_InBudgetHandler = false;
+
+static TagHeader* GetHeader(void* ptr) { return reinterpret_cast<TagHeader*>(ptr) - 1; }
+
+static void LogOverBudget(MemoryTag tag, u64 live, u64 budget)
+{
+	ILOG(LogMemory, Warning, "{} is over its memory budget: {} of {} bytes", MemoryTracking::GetTagName(tag), live,
+		budget);
+}
+
+static void AddLive(MemoryTag tag, u64 size)
+{
+	TagState& state = s_Tags[u64(tag)];
+	u64 live = state.Live.fetch_add(size, std::memory_order::relaxed) + size;
+
+	u64 peak = state.Peak.load(std::memory_order::relaxed);
+	while (live > peak && !state.Peak.compare_exchange_weak(peak, live, std::memory_order::relaxed)) {}
+
+	u64 budget = state.Budget.load(std::memory_order::relaxed);
+	if (budget && live > budget && live - size <= budget && !t_InBudgetHandler)
+	{
+		t_InBudgetHandler = true;
+		s_BudgetHandler.load(std::memory_order::relaxed)(tag, live, budget);
+		t_InBudgetHandler = false;
+	}
+}
+
+static void Track(MemoryTag tag, TagHeader* header)
+{
+	TagState& state = s_Tags[u64(tag)];
+	state.Count.fetch_add(1, std::memory_order::relaxed);
+	state.Total.fetch_add(1, std::memory_order::relaxed);
+	AddLive(tag, header->Size);
+
+#ifndef NDEBUG
+	while (state.Lock.test_and_set(std::memory_order::acquire)) {}
+
+	header->Prev = nullptr;
+	header->Next = state.Head;
+	if (state.Head)
+	{
+		state.Head->Prev = header;
+	}
+	state.Head = header;
+
+	state.Lock.clear(std::memory_order::release);
+#endif
+}
+
+static void Untrack(MemoryTag tag, TagHeader* header)
+{
+	TagState& state = s_Tags[u64(tag)];
+	state.Count.fetch_sub(1, std::memory_order::relaxed);
+	state.Live.fetch_sub(header->Size, std::memory_order::relaxed);
+
+#ifndef NDEBUG
+	while (state.Lock.test_and_set(std::memory_order::acquire)) {}
+
+	if (header->Prev)
+	{
+		header->Prev->Next = header->Next;
+	}
+	else
+	{
+		state.Head = header->Next;
+	}
+
+	if (header->Next)
+	{
+		header->Next->Prev = header->Prev;
+	}
+
+	state.Lock.clear(std::memory_order::release);
+#endif
+}
+
+TaggedAllocator::TaggedAllocator(MemoryTag tag, Allocator& alloc) : m_Tag(tag), m_Alloc(&alloc)
+{
+	IASSERT(u64(tag) < MaxMemoryTags, "Memory tag is out of range");
+}
+
+void* TaggedAllocator::Allocate(u64 size) { return Allocate(size, 16, CALL_SITE()); }
+
+void* TaggedAllocator::Allocate(u64 size, u64 alignment) { return Allocate(size, alignment, CALL_SITE()); }
+
+void TaggedAllocator::Deallocate(void* ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	TagHeader* header = GetHeader(ptr);
+	Untrack(m_Tag, header);
+
+	// Only allocations with at most 16 byte alignment have the header right at the start.
+	u8* block = reinterpret_cast<u8*>(ptr) - header->Offset;
+	if (header->Offset == sizeof(TagHeader))
+	{
+		m_Alloc->Deallocate(block, header->Offset + header->Size);
+	}
+	else
+	{
+		m_Alloc->Deallocate(block);
+	}
+}
+
+u64 TaggedAllocator::GrowAllocation(void* ptr, u64 oldSize, u64 newSize)
+{
+	if (!ptr)
+	{
+		return oldSize;
+	}
+
+	TagHeader* header = GetHeader(ptr);
+	u64 offset = header->Offset;
+	u64 size = m_Alloc->GrowAllocation(reinterpret_cast<u8*>(ptr) - offset, offset + header->Size, offset + newSize);
+	if (size - offset > header->Size)
+	{
+		AddLive(m_Tag, size - offset - header->Size);
+		header->Size = size - offset;
+	}
+
+	return header->Size;
+}
+
+void* TaggedAllocator::Allocate(u64 size, u64 alignment, void* callSite)
+{
+	if (alignment < 16)
+	{
+		alignment = 16;
+	}
+
+	u64 offset = (sizeof(TagHeader) + alignment - 1) & ~(alignment - 1);
+	auto block = reinterpret_cast<u8*>(m_Alloc->Allocate(offset + size, alignment));
+	if (!block)
+	{
+		return nullptr;
+	}
+
+	u8* ptr = block + offset;
+	TagHeader* header = GetHeader(ptr);
+	header->Size = size;
+	header->Offset = offset;
+#ifndef NDEBUG
+	header->CallSite = callSite;
+#endif
+	Track(m_Tag, header);
+
+	return ptr;
+}
+
+namespace MemoryTracking {
+
+/// Log leaks, through sink if it is not nullptr.
+/// The report at shutdown goes to a sink directly, as the Logger is gone by then.
+static u64 Report(LogSink* sink)
+{
+	u64 leaks = 0;
+	for (u64 tag = 0; tag < MaxMemoryTags; tag++)
+	{
+		TagState& state = s_Tags[tag];
+		u64 count = state.Count.load(std::memory_order::relaxed);
+		if (!count)
+		{
+			continue;
+		}
+
+		leaks += count;
+		u64 live = state.Live.load(std::memory_order::relaxed);
+		StringRef name = GetTagName(MemoryTag(tag));
+		if (sink)
+		{
+			sink->Sink(LogLevel::Warning, Format("{} leaked {} bytes in {} allocations", name, live, count));
+		}
+		else
+		{
+			ILOG(LogMemory, Warning, "{} leaked {} bytes in {} allocations", name, live, count);
+		}
+
+#ifndef NDEBUG
+		// Logging allocates, possibly from this very tag, so copy the call sites out before logging them.
+		constexpr u64 maxSites = 64;
+		Pair<void*, u64> sites[maxSites];
+		u64 siteCount = 0;
+
+		while (state.Lock.test_and_set(std::memory_order::acquire)) {}
+
+		for (TagHeader* header = state.Head; header && siteCount < maxSites; header = header->Next)
+		{
+			sites[siteCount++] = { header->CallSite, header->Size };
+		}
+
+		state.Lock.clear(std::memory_order::release);
+
+		for (u64 i = 0; i < siteCount; i++)
+		{
+			if (sink)
+			{
+				sink->Sink(LogLevel::Warning,
+					Format("    {} bytes allocated from {:#x}", sites[i].Second, u64(sites[i].First)));
+			}
+			else
+			{
+				ILOG(LogMemory, Warning, "    {} bytes allocated from {:#x}", sites[i].Second, u64(sites[i].First));
+			}
+		}
+#endif
+	}
+
+	return leaks;
+}
+
+/// Reports leaks once everything else has been destroyed.
+struct LeakReporter
+{
+	~LeakReporter()
+	{
+		StdoutSink sink;
+		Report(&sink);
+	}
+};
+
+#ifdef COMPILER_MSVC
+#	pragma init_seg(lib)
+static LeakReporter s_LeakReporter;
+#else
+static LeakReporter s_LeakReporter __attribute__((init_priority(102)));
+#endif
+
+/// Storage for the shared allocators of every tag.
+struct TagAllocators
+{
+	TagAllocators()
+	{
+		for (u64 tag = 0; tag < MaxMemoryTags; tag++)
+		{
+			Construct<TaggedAllocator>(&Allocators[tag], MemoryTag(tag));
+		}
+	}
+
+	// Never destroyed, as allocations made from them can be freed at any point of static destruction.
+	~TagAllocators() {}
+
+	union
+	{
+		TaggedAllocator Allocators[MaxMemoryTags];
+	};
+};
+
+Allocator& GetAllocator(MemoryTag tag)
+{
+#ifdef IGNIS_MEMORY_TRACKING
+	// Constructed on first use, as other subsystems grab their allocators during static initialization.
+	static TagAllocators allocators;
+	return allocators.Allocators[u64(tag)];
+#else
+	return GAlloc;
+#endif
+}
+
+MemoryTagStats GetStats(MemoryTag tag)
+{
+	TagState& state = s_Tags[u64(tag)];
+	return { state.Live.load(std::memory_order::relaxed), state.Peak.load(std::memory_order::relaxed),
+		state.Count.load(std::memory_order::relaxed), state.Total.load(std::memory_order::relaxed),
+		state.Budget.load(std::memory_order::relaxed) };
+}
+
+void SetTagName(MemoryTag tag, const char* name)
+{
+	IASSERT(tag >= MemoryTag::User, "Only user tags can be renamed");
+	s_Names[u64(tag)] = name;
+}
+
+StringRef GetTagName(MemoryTag tag) { return s_Names[u64(tag)] ? s_Names[u64(tag)] : "User"; }
+
+void SetBudget(MemoryTag tag, u64 budget) { s_Tags[u64(tag)].Budget.store(budget, std::memory_order::relaxed); }
+
+void SetBudgetHandler(BudgetHandler handler) { s_BudgetHandler.store(handler, std::memory_order::relaxed); }
+
+u64 ReportLeaks() { return Report(nullptr); }
+
+}
+
+}
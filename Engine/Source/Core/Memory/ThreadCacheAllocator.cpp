@@ -0,0 +1,429 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Memory/ThreadCacheAllocator.h"
+
+#include <cstdlib>
+
+#include "Core/Memory/RawAllocator.h"
+#include "Core/Misc/Assert.h"
+#include "Core/Platform/Thread.h"
+
+#ifdef COMPILER_MSVC
+#	include <intrin.h>
+#	include <malloc.h>
+#endif
+
+namespace Ignis {
+
+/// Ensuring that GCacheAlloc is constructed before anything else and destroyed last, as it can be GAlloc.
+#ifdef COMPILER_MSVC
+#	pragma init_seg(lib)
+ThreadCacheAllocator GCacheAlloc;
+#else
+ThreadCacheAllocator GCacheAlloc __attribute__((init_priority(101)));
+#endif
+
+/// Header at the start of every span.
+struct SpanHeader
+{
+	/// Size class of the blocks in the span. Is LargeClass or MappedClass if the span holds a single large allocation.
+	u64 SizeClass;
+
+	/// Usable size of each block in the span.
+	u64 Size;
+};
+
+static constexpr u64 LargeClass = u64(-1);
+
+/// Large span allocated from GRawAlloc with its own mapping, so it can grow in place.
+static constexpr u64 MappedClass = u64(-2);
+
+static u64 FloorLog2(u64 value)
+{
+#ifdef COMPILER_MSVC
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return index;
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+static constexpr u64 ClassSize(u64 sizeClass)
+{
+	if (sizeClass < 8)
+	{
+		return (sizeClass + 1) * 16;
+	}
+
+	u64 base = u64(128) << ((sizeClass - 8) / 4);
+	return base + ((sizeClass - 8) % 4 + 1) * (base / 4);
+}
+
+static_assert(ClassSize(ThreadCacheAllocator::ClassCount - 1) == ThreadCacheAllocator::MaxSmallSize,
+	"Size classes must cover every small allocation");
+
+static u64 SizeClassOf(u64 size)
+{
+	if (size <= 128)
+	{
+		return size ? (size + 15) / 16 - 1 : 0;
+	}
+
+	u64 n = size - 1;
+	u64 shift = FloorLog2(n);
+	return 8 + (shift - 7) * 4 + ((n >> (shift - 2)) & 3);
+}
+
+/// Number of blocks moved between a thread cache and the central list at once.
+/// Roughly 16 KB worth of blocks, so that large classes don't hoard memory in caches.
+static constexpr u64 BatchCount(u64 sizeClass)
+{
+	u64 count = 16 * 1024 / ClassSize(sizeClass);
+	return count < 2 ? 2 : count > 64 ? 64 : count;
+}
+
+static SpanHeader* GetSpan(void* ptr)
+{
+	return reinterpret_cast<SpanHeader*>(u64(ptr) & ~(ThreadCacheAllocator::SpanSize - 1));
+}
+
+static SpanHeader* AllocateSpan(u64 size)
+{
+#ifdef COMPILER_MSVC
+	return reinterpret_cast<SpanHeader*>(_aligned_malloc(size, ThreadCacheAllocator::SpanSize));
+#else
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, ThreadCacheAllocator::SpanSize, size) != 0)
+	{
+		return nullptr;
+	}
+	return reinterpret_cast<SpanHeader*>(ptr);
+#endif
+}
+
+static void FreeSpan(SpanHeader* span)
+{
+#ifdef COMPILER_MSVC
+	_aligned_free(span);
+#else
+	free(span);
+#endif
+}
+
+void* ThreadCacheAllocator::Allocate(u64 size)
+{
+	if (size > MaxSmallSize)
+	{
+		return AllocateLarge(size, SpanHeaderSize);
+	}
+
+	u64 sizeClass = SizeClassOf(size);
+	ThreadCache* cache = GetCache();
+	if (!cache)
+	{
+		u64 count = 1;
+		return Fetch(sizeClass, count);
+	}
+
+	if (!cache->Lists[sizeClass])
+	{
+		u64 count = BatchCount(sizeClass);
+		cache->Lists[sizeClass] = Fetch(sizeClass, count);
+		cache->Counts[sizeClass] = u32(count);
+		if (!count)
+		{
+			return nullptr;
+		}
+	}
+
+	FreeBlock* block = cache->Lists[sizeClass];
+	cache->Lists[sizeClass] = block->Next;
+	cache->Counts[sizeClass]--;
+
+	return block;
+}
+
+void* ThreadCacheAllocator::Allocate(u64 size, u64 alignment)
+{
+	if (alignment <= 16)
+	{
+		return Allocate(size);
+	}
+
+	// Blocks start at a 64 byte offset in their span, and the size class picked for a multiple of 32 or 64 is itself a
+	// multiple of it, so rounding up the size is enough to keep every block in the class aligned.
+	if (alignment <= SpanHeaderSize)
+	{
+		u64 rounded = (size + alignment - 1) & ~(alignment - 1);
+		if (rounded <= MaxSmallSize)
+		{
+			return Allocate(rounded);
+		}
+	}
+
+	return AllocateLarge(size, alignment);
+}
+
+void ThreadCacheAllocator::Deallocate(void* ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	SpanHeader* span = GetSpan(ptr);
+	if (span->SizeClass == LargeClass)
+	{
+		FreeSpan(span);
+		return;
+	}
+
+	if (span->SizeClass == MappedClass)
+	{
+		GRawAlloc.Deallocate(span);
+		return;
+	}
+
+	DeallocateSmall(ptr, span->SizeClass);
+}
+
+void ThreadCacheAllocator::Deallocate(void* ptr, u64 size)
+{
+	if (!ptr || size > MaxSmallSize)
+	{
+		Deallocate(ptr);
+		return;
+	}
+
+	u64 sizeClass = SizeClassOf(size);
+	IASSERT(sizeClass == GetSpan(ptr)->SizeClass, "Wrong size passed to ThreadCacheAllocator::Deallocate");
+	DeallocateSmall(ptr, sizeClass);
+}
+
+void ThreadCacheAllocator::DeallocateSmall(void* ptr, u64 sizeClass)
+{
+	auto block = reinterpret_cast<FreeBlock*>(ptr);
+	ThreadCache* cache = GetCache();
+	if (!cache)
+	{
+		Release(sizeClass, block, block);
+		return;
+	}
+
+	block->Next = cache->Lists[sizeClass];
+	cache->Lists[sizeClass] = block;
+	cache->Counts[sizeClass]++;
+
+	// Keep at most two batches around, and hand the most recently freed batch back.
+	u64 batch = BatchCount(sizeClass);
+	if (cache->Counts[sizeClass] > batch * 2)
+	{
+		FreeBlock* first = cache->Lists[sizeClass];
+		FreeBlock* last = first;
+		for (u64 i = 1; i < batch; i++)
+		{
+			last = last->Next;
+		}
+
+		cache->Lists[sizeClass] = last->Next;
+		cache->Counts[sizeClass] -= u32(batch);
+		Release(sizeClass, first, last);
+	}
+}
+
+u64 ThreadCacheAllocator::GrowAllocation(void* ptr, u64 oldSize, u64 newSize)
+{
+	if (!ptr)
+	{
+		return oldSize;
+	}
+
+	// Blocks are already as large as their size class, so growth within the class is free.
+	SpanHeader* span = GetSpan(ptr);
+	if (span->SizeClass == MappedClass && newSize > span->Size)
+	{
+		u64 offset = u64(ptr) - u64(span);
+		span->Size = GRawAlloc.GrowAllocation(span, offset + span->Size, offset + newSize) - offset;
+	}
+
+	return span->Size;
+}
+
+void ThreadCacheAllocator::FlushThreadCache()
+{
+	ThreadCache* cache = GetCache();
+	if (cache)
+	{
+		Flush(cache);
+	}
+}
+
+void ThreadCacheAllocator::ExitThread()
+{
+	ThreadCache* cache = GetCache();
+	Flush(cache);
+	cache->Registered = false;
+}
+
+void ThreadCacheAllocator::Flush(ThreadCache* cache)
+{
+	for (u64 sizeClass = 0; sizeClass < ClassCount; sizeClass++)
+	{
+		FreeBlock* first = cache->Lists[sizeClass];
+		if (!first)
+		{
+			continue;
+		}
+
+		FreeBlock* last = first;
+		while (last->Next)
+		{
+			last = last->Next;
+		}
+
+		cache->Lists[sizeClass] = nullptr;
+		cache->Counts[sizeClass] = 0;
+		Release(sizeClass, first, last);
+	}
+}
+
+void* ThreadCacheAllocator::AllocateLarge(u64 size, u64 alignment)
+{
+	IASSERT(alignment <= SpanSize / 2, "Alignment is too large for the ThreadCacheAllocator");
+
+	// The allocation must start within the first SpanSize bytes, so that masking the pointer finds the header.
+	u64 offset = alignment > SpanHeaderSize ? alignment : SpanHeaderSize;
+	SpanHeader* span;
+	if (offset + size >= RawAllocator::MapThreshold)
+	{
+		span = reinterpret_cast<SpanHeader*>(GRawAlloc.Allocate(offset + size, SpanSize));
+		if (!span)
+		{
+			return nullptr;
+		}
+		span->SizeClass = MappedClass;
+	}
+	else
+	{
+		span = AllocateSpan(offset + size);
+		if (!span)
+		{
+			return nullptr;
+		}
+		span->SizeClass = LargeClass;
+	}
+	span->Size = size;
+
+	return reinterpret_cast<u8*>(span) + offset;
+}
+
+/// Flushes the caches a thread used when it exits, before its index is handed to another thread.
+struct ThreadCacheFlusher
+{
+	~ThreadCacheFlusher()
+	{
+		for (u64 i = 0; i < Count; i++)
+		{
+			Allocators[i]->ExitThread();
+		}
+		Exited = true;
+	}
+
+	/// A thread rarely uses more than GCacheAlloc. Caches of any allocators past these are picked up by the next
+	/// thread with the same index instead.
+	ThreadCacheAllocator* Allocators[8] = {};
+	u64 Count = 0;
+
+	/// Set once the caches are flushed, so that frees during the rest of the thread's exit go to the central lists.
+	bool Exited = false;
+};
+
+static thread_local ThreadCacheFlusher t_Flusher;
+
+ThreadCacheAllocator::ThreadCache* ThreadCacheAllocator::GetCache()
+{
+	u32 index = Thread::GetCurrentIndex();
+	if (index >= MaxCachedThreads || t_Flusher.Exited)
+	{
+		return nullptr;
+	}
+
+	ThreadCache* cache = &m_Caches[index];
+	if (!cache->Registered)
+	{
+		// The first use of t_Flusher constructs it after the thread's index, so it is destroyed before the index
+		// is handed back.
+		cache->Registered = true;
+		if (t_Flusher.Count < 8)
+		{
+			t_Flusher.Allocators[t_Flusher.Count++] = this;
+		}
+	}
+
+	return cache;
+}
+
+ThreadCacheAllocator::FreeBlock* ThreadCacheAllocator::Fetch(u64 sizeClass, u64& count)
+{
+	CentralList& central = m_Central[sizeClass];
+	while (central.Lock.test_and_set(std::memory_order::acquire)) {}
+
+	FreeBlock* list = nullptr;
+	for (u64 i = 0; i < count; i++)
+	{
+		if (!central.Head && !CarveSpan(sizeClass))
+		{
+			count = i;
+			break;
+		}
+
+		FreeBlock* block = central.Head;
+		central.Head = block->Next;
+		block->Next = list;
+		list = block;
+	}
+
+	central.Lock.clear(std::memory_order::release);
+
+	return list;
+}
+
+void ThreadCacheAllocator::Release(u64 sizeClass, FreeBlock* first, FreeBlock* last)
+{
+	CentralList& central = m_Central[sizeClass];
+	while (central.Lock.test_and_set(std::memory_order::acquire)) {}
+
+	last->Next = central.Head;
+	central.Head = first;
+
+	central.Lock.clear(std::memory_order::release);
+}
+
+bool ThreadCacheAllocator::CarveSpan(u64 sizeClass)
+{
+	u64 size = ClassSize(sizeClass);
+	SpanHeader* span = AllocateSpan(SpanSize);
+	if (!span)
+	{
+		return false;
+	}
+	span->SizeClass = sizeClass;
+	span->Size = size;
+
+	// Link in reverse so that the blocks are handed out in address order.
+	u8* data = reinterpret_cast<u8*>(span) + SpanHeaderSize;
+	FreeBlock* list = m_Central[sizeClass].Head;
+	for (u64 i = (SpanSize - SpanHeaderSize) / size; i > 0; i--)
+	{
+		auto block = reinterpret_cast<FreeBlock*>(data + (i - 1) * size);
+		block->Next = list;
+		list = block;
+	}
+
+	m_Central[sizeClass].Head = list;
+
+	return true;
+}
+
+}
@@ -3,18 +3,40 @@
 #include "Core/Misc/Log.h"
 
 #include <cstdio>
+#include <new>
 
 #include "fmt/color.h"
 #include "fmt/core.h"
 
 #include "Core/Misc/Format.h"
 #include "Core/Platform/Internals.h"
+#include "Core/Types/StaticMap.h"
 
 namespace Ignis {
 
-Logger* Logger::s_Logger = nullptr;
+static Logger* s_Logger = nullptr;
 
-Logger::Logger()
+/// Flushes the sinks once everything else has been destroyed, as the Logger never is.
+struct LogFlusher
+{
+	~LogFlusher()
+	{
+		if (s_Logger)
+		{
+			s_Logger->Flush();
+		}
+	}
+};
+
+#ifdef COMPILER_MSVC
+#	pragma init_seg(lib)
+static LogFlusher s_LogFlusher;
+#else
+static LogFlusher s_LogFlusher __attribute__((init_priority(103)));
+#endif
+
+// The sinks live as long as the Logger, so they are kept out of the Log tag instead of being reported as leaks.
+Logger::Logger() : m_Alloc(&MemoryTracking::GetAllocator(MemoryTag::Log)), m_Sinks(GAlloc)
 {
 	m_Sinks.Push(MakeUnique<StdoutSink>());
 	m_Sinks.Push(MakeUnique<DebugSink>());
@@ -22,37 +44,36 @@ Logger::Logger()
 
 StringRef Logger::LevelToString(LogLevel level)
 {
-	switch (level)
-	{
-	case LogLevel::Verbose:
-		return "Verbose";
-	case LogLevel::Debug:
-		return "Debug";
-	case LogLevel::Log:
-		return "Log";
-	case LogLevel::Warning:
-		return "Warning";
-	case LogLevel::Error:
-		return "Error";
-	case LogLevel::Fatal:
-		return "Fatal";
-	}
+	static constexpr auto s_Names = MakeStaticMap<LogLevel, StringRef>({
+		{ LogLevel::Verbose, "Verbose" },
+		{ LogLevel::Debug, "Debug" },
+		{ LogLevel::Log, "Log" },
+		{ LogLevel::Warning, "Warning" },
+		{ LogLevel::Error, "Error" },
+		{ LogLevel::Fatal, "Fatal" },
+	});
 
-	return "";
+	return s_Names.GetOr(level, "");
 }
 
 Logger* Logger::Get()
 {
-	if (!s_Logger)
-	{
-		s_Logger = new Logger;
-	}
-
-	return s_Logger;
+	// Never destroyed, as statics can log while being destroyed, in any order.
+	alignas(Logger) static u8 storage[sizeof(Logger)];
+	static Logger* logger = s_Logger = new (storage) Logger();
+	return logger;
 }
 
 void Logger::AddSink(UniquePtr<LogSink>&& sink) { m_Sinks.Emplace(std::move(sink)); }
 
+void Logger::Flush()
+{
+	for (auto& sink : m_Sinks)
+	{
+		sink->Flush();
+	}
+}
+
 void StdoutSink::Sink(LogLevel level, StringRef message)
 {
 	switch (level)
@@ -72,6 +93,8 @@ void StdoutSink::Sink(LogLevel level, StringRef message)
 	}
 }
 
+void StdoutSink::Flush() { fflush(stdout); }
+
 void DebugSink::Sink(LogLevel level, StringRef message)
 {
 	PlatformInternals::DebugOutput(message + "\n");
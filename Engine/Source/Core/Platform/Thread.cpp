@@ -2,6 +2,9 @@
 
 #include "Core/Platform/Thread.h"
 
+#include <atomic>
+#include <bit>
+
 #include "Core/Platform/Internals.h"
 #include "Core/Platform/Platform.h"
 
@@ -142,3 +145,65 @@ u16 Thread::GetMaxThreads()
 }
 
 #endif
+
+namespace Ignis {
+
+/// Indices below this are handed back when their thread exits. Past it, indices are never reused.
+static constexpr u32 ReusedIndexCount = 1024;
+static constexpr u32 NoIndex = u32(-1);
+
+static std::atomic<u64> s_UsedIndices[ReusedIndexCount / 64];
+static std::atomic<u32> s_NextIndex = ReusedIndexCount;
+static thread_local u32 t_Index = NoIndex;
+
+/// Take the lowest free index, so indices stay dense as threads come and go.
+static u32 AcquireIndex()
+{
+	for (u32 word = 0; word < ReusedIndexCount / 64; word++)
+	{
+		u64 used = s_UsedIndices[word].load(std::memory_order::relaxed);
+		while (~used)
+		{
+			u64 bit = u64(1) << std::countr_one(used);
+			if (s_UsedIndices[word].compare_exchange_weak(
+					used, used | bit, std::memory_order::acquire, std::memory_order::relaxed))
+			{
+				return word * 64 + u32(std::countr_zero(bit));
+			}
+		}
+	}
+
+	return s_NextIndex.fetch_add(1, std::memory_order::relaxed);
+}
+
+/// Hands the index of a thread back when it exits.
+struct ThreadIndexOwner
+{
+	~ThreadIndexOwner()
+	{
+		// Anything that still runs during the thread's exit gets an index that is never reused.
+		u32 index = t_Index;
+		t_Index = s_NextIndex.fetch_add(1, std::memory_order::relaxed);
+
+		if (index < ReusedIndexCount)
+		{
+			s_UsedIndices[index / 64].fetch_and(~(u64(1) << (index % 64)), std::memory_order::release);
+		}
+	}
+};
+
+u32 Thread::GetCurrentIndex()
+{
+	if (t_Index == NoIndex)
+	{
+		t_Index = AcquireIndex();
+
+		// Constructed here, after the index, so thread_locals that use the index are destroyed before it is released.
+		static thread_local ThreadIndexOwner t_Owner;
+		(void)t_Owner;
+	}
+
+	return t_Index;
+}
+
+}
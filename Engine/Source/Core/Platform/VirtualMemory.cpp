@@ -0,0 +1,264 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Platform/VirtualMemory.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+
+namespace Ignis {
+
+namespace VirtualMemory {
+
+static DWORD ToPlatform(Protection protection)
+{
+	switch (protection)
+	{
+	case Protection::None:
+		return PAGE_NOACCESS;
+	case Protection::Read:
+		return PAGE_READONLY;
+	case Protection::ReadWrite:
+		return PAGE_READWRITE;
+	case Protection::ReadExecute:
+		return PAGE_EXECUTE_READ;
+	}
+
+	return PAGE_NOACCESS;
+}
+
+void* Reserve(u64 size) { return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS); }
+
+void* ReserveAligned(u64 size, u64 alignment)
+{
+	if (alignment <= GetPageSize())
+	{
+		return Reserve(size);
+	}
+
+	// Parts of a reservation can't be released, so find a large enough hole and reserve the aligned part of it.
+	// Another thread can take the hole in between, so try a few times.
+	for (u32 attempt = 0; attempt < 8; attempt++)
+	{
+		void* hole = Reserve(size + alignment);
+		if (!hole)
+		{
+			return nullptr;
+		}
+		Release(hole, size + alignment);
+
+		auto aligned = reinterpret_cast<void*>((u64(hole) + alignment - 1) & ~(alignment - 1));
+		if (void* ptr = VirtualAlloc(aligned, size, MEM_RESERVE, PAGE_NOACCESS))
+		{
+			return ptr;
+		}
+	}
+
+	return nullptr;
+}
+
+bool Commit(void* ptr, u64 size) { return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr; }
+
+void Decommit(void* ptr, u64 size) { VirtualFree(ptr, size, MEM_DECOMMIT); }
+
+void Release(void* ptr, u64 size) { VirtualFree(ptr, 0, MEM_RELEASE); }
+
+bool Protect(void* ptr, u64 size, Protection protection)
+{
+	DWORD old;
+	return VirtualProtect(ptr, size, ToPlatform(protection), &old);
+}
+
+// A second reservation right after the region would have to be released on its own.
+bool ExtendReservation(void* ptr, u64 oldSize, u64 newSize) { return false; }
+
+void* CommitHuge(u64 size)
+{
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+}
+
+bool AdviseHugePages(void* ptr, u64 size) { return false; }
+
+u64 GetPageSize()
+{
+	static const u64 size = []
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return u64(info.dwPageSize);
+	}();
+
+	return size;
+}
+
+u64 GetHugePageSize()
+{
+	static const u64 size = GetLargePageMinimum();
+	return size;
+}
+
+}
+
+}
+
+#else
+
+#	include <cstdio>
+#	include <cstring>
+#	include <sys/mman.h>
+#	include <unistd.h>
+
+namespace Ignis {
+
+namespace VirtualMemory {
+
+static int ToPlatform(Protection protection)
+{
+	switch (protection)
+	{
+	case Protection::None:
+		return PROT_NONE;
+	case Protection::Read:
+		return PROT_READ;
+	case Protection::ReadWrite:
+		return PROT_READ | PROT_WRITE;
+	case Protection::ReadExecute:
+		return PROT_READ | PROT_EXEC;
+	}
+
+	return PROT_NONE;
+}
+
+void* Reserve(u64 size)
+{
+	void* ptr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+void* ReserveAligned(u64 size, u64 alignment)
+{
+	if (alignment <= GetPageSize())
+	{
+		return Reserve(size);
+	}
+
+	size = (size + GetPageSize() - 1) & ~(GetPageSize() - 1);
+	auto region = reinterpret_cast<u8*>(Reserve(size + alignment));
+	if (!region)
+	{
+		return nullptr;
+	}
+
+	// Unmap the pages around the aligned part, so it is a region of its own.
+	auto ptr = reinterpret_cast<u8*>((u64(region) + alignment - 1) & ~(alignment - 1));
+	if (ptr != region)
+	{
+		munmap(region, u64(ptr - region));
+	}
+	munmap(ptr + size, u64(region + size + alignment - (ptr + size)));
+
+	return ptr;
+}
+
+bool Commit(void* ptr, u64 size) { return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0; }
+
+void Decommit(void* ptr, u64 size)
+{
+	// Mapping fresh pages over the old ones drops their memory and their commit charge in one go.
+	mmap(ptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+}
+
+void Release(void* ptr, u64 size) { munmap(ptr, size); }
+
+bool Protect(void* ptr, u64 size, Protection protection) { return mprotect(ptr, size, ToPlatform(protection)) == 0; }
+
+bool ExtendReservation(void* ptr, u64 oldSize, u64 newSize)
+{
+#	ifdef PLATFORM_LINUX
+	// Without MREMAP_MAYMOVE this only succeeds if the address space right after the region is free,
+	// and the region must be a single mapping, so all of it must be committed.
+	return mremap(ptr, oldSize, newSize, 0) != MAP_FAILED;
+#	else
+	return false;
+#	endif
+}
+
+void* CommitHuge(u64 size)
+{
+#	ifdef PLATFORM_LINUX
+	// Not MAP_NORESERVE, so that running out of huge pages fails here instead of faulting on first touch.
+	void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	return ptr == MAP_FAILED ? nullptr : ptr;
+#	else
+	return nullptr;
+#	endif
+}
+
+bool AdviseHugePages(void* ptr, u64 size)
+{
+#	ifdef PLATFORM_LINUX
+	// madvise succeeds even if transparent huge pages are turned off, so check the setting as well.
+	static const bool enabled = []
+	{
+		FILE* file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+		if (!file)
+		{
+			return false;
+		}
+
+		char setting[128] = {};
+		fgets(setting, sizeof(setting), file);
+		fclose(file);
+
+		return strstr(setting, "[never]") == nullptr;
+	}();
+
+	return enabled && madvise(ptr, size, MADV_HUGEPAGE) == 0;
+#	else
+	return false;
+#	endif
+}
+
+u64 GetPageSize()
+{
+	static const u64 size = u64(sysconf(_SC_PAGESIZE));
+	return size;
+}
+
+u64 GetHugePageSize()
+{
+#	ifdef PLATFORM_LINUX
+	static const u64 size = []
+	{
+		FILE* file = fopen("/proc/meminfo", "r");
+		if (!file)
+		{
+			return u64(0);
+		}
+
+		unsigned long long kb = 0;
+		char line[256];
+		while (fgets(line, sizeof(line), file))
+		{
+			if (sscanf(line, "Hugepagesize: %llu kB", &kb) == 1)
+			{
+				break;
+			}
+		}
+		fclose(file);
+
+		return u64(kb) * 1024;
+	}();
+
+	return size;
+#	else
+	return 0;
+#	endif
+}
+
+}
+
+}
+
+#endif
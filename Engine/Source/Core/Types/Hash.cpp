@@ -0,0 +1,99 @@
+/// Copyright (c) 2021 Shaye Garg.
+
+#include "Core/Types/Hash.h"
+
+#include <cstring>
+
+namespace Ignis {
+
+static constexpr u64 s_Secret[4] = { 0x2D358DCCAA6C78A5, 0x8BB84B93962EACC9, 0x4B33A62ED433D4A3, 0x4D5A2DA51DE1AA47 };
+
+static u64 Read8(const u8* ptr)
+{
+	u64 value;
+	memcpy(&value, ptr, 8);
+	return value;
+}
+
+static u64 Read4(const u8* ptr)
+{
+	u32 value;
+	memcpy(&value, ptr, 4);
+	return value;
+}
+
+// Reads 1 to 3 bytes, touching the first, middle and last byte.
+static u64 Read3(const u8* ptr, u64 size) { return (u64(ptr[0]) << 16) | (u64(ptr[size >> 1]) << 8) | ptr[size - 1]; }
+
+u64 HashBytes(const void* data, u64 size, u64 seed)
+{
+	auto ptr = reinterpret_cast<const u8*>(data);
+	seed ^= Private::MulFold(seed ^ s_Secret[0], s_Secret[1]);
+
+	u64 a, b;
+	if (size <= 16)
+	{
+		// Short keys are read with overlapping loads instead of a loop.
+		if (size >= 4)
+		{
+			u64 offset = (size >> 3) << 2;
+			a = (Read4(ptr) << 32) | Read4(ptr + offset);
+			b = (Read4(ptr + size - 4) << 32) | Read4(ptr + size - 4 - offset);
+		}
+		else if (size > 0)
+		{
+			a = Read3(ptr, size);
+			b = 0;
+		}
+		else
+		{
+			a = b = 0;
+		}
+	}
+	else
+	{
+		u64 left = size;
+		if (left > 48)
+		{
+			// Three independent lanes, so the multiplies can run in parallel.
+			u64 seed1 = seed, seed2 = seed;
+			do
+			{
+				seed = Private::MulFold(Read8(ptr) ^ s_Secret[1], Read8(ptr + 8) ^ seed);
+				seed1 = Private::MulFold(Read8(ptr + 16) ^ s_Secret[2], Read8(ptr + 24) ^ seed1);
+				seed2 = Private::MulFold(Read8(ptr + 32) ^ s_Secret[3], Read8(ptr + 40) ^ seed2);
+				ptr += 48;
+				left -= 48;
+			} while (left > 48);
+
+			seed ^= seed1 ^ seed2;
+		}
+
+		while (left > 16)
+		{
+			seed = Private::MulFold(Read8(ptr) ^ s_Secret[1], Read8(ptr + 8) ^ seed);
+			ptr += 16;
+			left -= 16;
+		}
+
+		a = Read8(ptr + left - 16);
+		b = Read8(ptr + left - 8);
+	}
+
+	a ^= s_Secret[1];
+	b ^= seed;
+
+	// The full product is needed here, not just its fold.
+#ifdef COMPILER_MSVC
+	u64 low = a * b;
+	u64 high = __umulh(a, b);
+#else
+	unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+	u64 low = u64(product);
+	u64 high = u64(product >> 64);
+#endif
+
+	return Private::MulFold(low ^ s_Secret[0] ^ size, high ^ s_Secret[1]);
+}
+
+}
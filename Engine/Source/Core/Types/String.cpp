@@ -2,6 +2,8 @@
 
 #include "Core/Types/String.h"
 
+#include <cstring>
+
 #include "Core/Memory/Memory.h"
 #include "Core/Misc/Assert.h"
 
@@ -98,19 +100,16 @@ StringIterator& StringIterator::operator+=(u64 offset)
 	return *this;
 }
 
-StringRef::StringRef(const char* ptr) : m_Data(reinterpret_cast<const Byte*>(ptr)) { m_Size = StrLen(ptr); }
-
-StringRef::StringRef(const char* ptr, u64 size) : m_Data(reinterpret_cast<const Byte*>(ptr)), m_Size(size) {}
-
-StringRef::StringRef(const String& string) : m_Data(string.CString()), m_Size(string.Size()) {}
-
-const Byte* StringRef::Data() const { return m_Data; }
+StringRef::StringRef(const String& string)
+	: m_Data(reinterpret_cast<const char*>(string.CString())), m_Size(string.Size())
+{
+}
 
-u64 StringRef::Size() const { return m_Size; }
+const Byte* StringRef::Data() const { return reinterpret_cast<const Byte*>(m_Data); }
 
-StringRef::Iterator StringRef::begin() const { return Iterator(m_Data); }
+StringRef::Iterator StringRef::begin() const { return Iterator(Data()); }
 
-StringRef::Iterator StringRef::end() const { return Iterator(m_Data + m_Size); }
+StringRef::Iterator StringRef::end() const { return Iterator(Data() + m_Size); }
 
 String::Repr::Repr() { MemSet(this, 0, sizeof(this)); }
 
@@ -203,6 +202,8 @@ String::String(String&& other)
 {
 	MemCopy(this, &other, sizeof(String));
 	other.SetSmall(true);
+	other.m_Repr.Small.Data[0] = 0;
+	other.m_Repr.Small.Data[m_SmallSize] = m_SmallSize;
 }
 
 String::~String()
@@ -253,8 +254,11 @@ String& String::operator=(String&& other)
 		m_Alloc->Deallocate(m_Repr.Big.Data);
 	}
 
+	// Leave other as an empty string with its allocator, so it can still be used and destroyed.
 	MemCopy(this, &other, sizeof(String));
-	MemSet(&other, 0, sizeof(String));
+	other.SetSmall(true);
+	other.m_Repr.Small.Data[0] = 0;
+	other.m_Repr.Small.Data[m_SmallSize] = m_SmallSize;
 
 	return *this;
 }
@@ -271,8 +275,10 @@ String& String::operator+=(StringRef view)
 	u64 newSize = Size() + view.Size();
 	Realloc(newSize);
 
-	MemCopy(Data() + Size(), view.Data(), view.Size() + 1);
+	// StringRefs are not null-terminated. A full small string's terminator is its size byte, so write it last.
+	MemCopy(Data() + Size(), view.Data(), view.Size());
 	IncSize(view.Size());
+	Data()[newSize] = '\0';
 
 	return *this;
 }
@@ -414,10 +420,12 @@ void String::Realloc(u64 size)
 	{
 		if (size > m_SmallSize)
 		{
+			u64 oldSize = m_SmallSize - m_Repr.Small.Data[m_SmallSize];
 			SetSmall(false);
 			void* data = GetAlloc()->Allocate(size + 1);
-			MemCopy(data, m_Repr.Small.Data, m_SmallSize - m_Repr.Small.Data[m_SmallSize]);
+			MemCopy(data, m_Repr.Small.Data, oldSize + 1);
 			m_Repr.Big.Data = reinterpret_cast<Byte*>(data);
+			m_Repr.Big.Size = oldSize;
 			m_Repr.Big.Capacity = size;
 		}
 	}
@@ -429,42 +437,30 @@ void String::Realloc(u64 size)
 			capacity *= 2;
 		}
 
-		u64 trySize = GetAlloc()->GrowAllocation(m_Repr.Big.Data, m_Repr.Big.Size, capacity + 1);
-		if (trySize < size)
+		// Sizes passed to the allocator include the null terminator.
+		u64 trySize = GetAlloc()->GrowAllocation(m_Repr.Big.Data, m_Repr.Big.Capacity + 1, capacity + 1);
+		if (trySize < capacity + 1)
 		{
 			void* data = GetAlloc()->Allocate(capacity + 1);
-			MemCopy(data, m_Repr.Big.Data, m_Repr.Big.Size);
+			MemCopy(data, m_Repr.Big.Data, m_Repr.Big.Size + 1);
 			GetAlloc()->Deallocate(m_Repr.Big.Data);
 			m_Repr.Big.Data = reinterpret_cast<Byte*>(data);
 			m_Repr.Big.Capacity = capacity;
 		}
 		else
 		{
-			m_Repr.Big.Capacity = trySize;
+			m_Repr.Big.Capacity = trySize - 1;
 		}
 	}
 }
 
-bool operator==(const String& first, const String& second)
+bool operator<(StringRef first, StringRef second)
 {
-	u64 size = first.Size();
-	if (size != second.Size())
-	{
-		return false;
-	}
-
-	if (first.IsSmall())
-	{
-		return MemCompare(first.m_Repr.Small.Data, second.m_Repr.Small.Data, size);
-	}
-	else
-	{
-		return MemCompare(first.m_Repr.Big.Data, second.m_Repr.Big.Data, size);
-	}
+	u64 size = first.Size() < second.Size() ? first.Size() : second.Size();
+	int order = size ? memcmp(first.Data(), second.Data(), size) : 0;
+	return order < 0 || (order == 0 && first.Size() < second.Size());
 }
 
-bool operator!=(const String& first, const String& second) { return !(first == second); }
-
 bool operator==(StringIterator first, StringIterator second) { return first.m_Byte == second.m_Byte; }
 
 bool operator!=(StringIterator first, StringIterator second) { return first.m_Byte != second.m_Byte; }
@@ -475,112 +471,6 @@ String operator+(StringRef first, StringRef second)
 	return str + second;
 }
 
-constexpr u32 FMix32(u32 h)
-{
-	h ^= h >> 16;
-	h *= 0x85ebca6b;
-	h ^= h >> 13;
-	h *= 0xc2b2ae35;
-	h ^= h >> 16;
-
-	return h;
-}
-
-u32 Rotl(u32 number, u32 places)
-{
-#ifdef COMPILER_MSVC
-	return _rotl(number, places);
-#else
-	return (number << places) | (number >> (32 - places));
-#endif
-}
-
-u64 Hasher<String>::Hash(const String& string)
-{
-	const u8* data = reinterpret_cast<const u8*>(string.CString());
-	u32 blockCount = string.Size() / 4;
-
-	u32 h1 = 192837465; // Seed
-	u32 c1 = 0xcc9e2d51;
-	u32 c2 = 0x1b873593;
-
-	const u32* blocks = reinterpret_cast<const u32*>(data + blockCount * 4);
-	for (i32 i = -blockCount; i; i++)
-	{
-		u32 k1 = blocks[i];
-
-		k1 *= c1;
-		k1 = Rotl(k1, 15);
-		k1 *= c2;
-
-		h1 ^= k1;
-		h1 = Rotl(h1, 13);
-		h1 = h1 * 5 + 0xe6546b64;
-	}
-
-	const u8* tail = reinterpret_cast<const u8*>(data + blockCount * 4);
-	u32 k1 = 0;
-
-	switch (string.Size() & 3)
-	{
-	case 3:
-		k1 ^= tail[2] << 16;
-	case 2:
-		k1 ^= tail[1] << 8;
-	case 1:
-		k1 ^= tail[0];
-		k1 *= c1;
-		k1 = Rotl(k1, 15);
-		k1 *= c2;
-		h1 ^= k1;
-	}
-
-	h1 ^= string.Size();
-	return FMix32(h1);
-}
-
-u64 Ignis::Hasher<StringRef>::Hash(const StringRef& string)
-{
-	const u8* data = reinterpret_cast<const u8*>(string.Data());
-	u32 blockCount = string.Size() / 4;
-
-	u32 h1 = 192837465; // Seed
-	u32 c1 = 0xcc9e2d51;
-	u32 c2 = 0x1b873593;
-
-	const u32* blocks = reinterpret_cast<const u32*>(data + blockCount * 4);
-	for (i32 i = -blockCount; i; i++)
-	{
-		u32 k1 = blocks[i];
-
-		k1 *= c1;
-		k1 = Rotl(k1, 15);
-		k1 *= c2;
-
-		h1 ^= k1;
-		h1 = Rotl(h1, 13);
-		h1 = h1 * 5 + 0xe6546b64;
-	}
-
-	const u8* tail = reinterpret_cast<const u8*>(data + blockCount * 4);
-	u32 k1 = 0;
-
-	switch (string.Size() & 3)
-	{
-	case 3:
-		k1 ^= tail[2] << 16;
-	case 2:
-		k1 ^= tail[1] << 8;
-	case 1:
-		k1 ^= tail[0];
-		k1 *= c1;
-		k1 = Rotl(k1, 15);
-		k1 *= c2;
-		h1 ^= k1;
-	}
-
-	h1 ^= string.Size();
-	return FMix32(h1);
-}
+u64 Hasher<StringRef>::Hash(StringRef string) { return HashBytes(string.Data(), string.Size()); }
 
 }